@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "src/allocator/allocator.h"
+#include "src/list/list.h"
+
+namespace {
+
+// CustomAllocator never reuses its fixed arena, so the lists built on it are kept small.
+constexpr std::size_t kCustomElements = 2000;
+constexpr std::size_t kStdElements = 1 << 20;
+constexpr std::size_t kTraversedElements = 1 << 28;
+// 256 MiB of links, far beyond what 4 KiB pages can cover from the TLB.
+constexpr std::size_t kArenaBytes = std::size_t{256} << 20;
+constexpr std::size_t kRandomRounds = 2;
+
+template <typename Iterator>
+std::int64_t Sum(Iterator first, Iterator last) {
+    std::int64_t sum = 0;
+    for (; first != last; ++first) {
+        sum += *first;
+    }
+    return sum;
+}
+
+template <typename Container, typename Traverse>
+void Run(const std::string& name, Container& container, std::size_t size, std::size_t rounds,
+         Traverse traverse) {
+    std::int64_t checksum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < rounds; ++i) {
+        checksum += traverse(container);
+    }
+    auto finish = std::chrono::steady_clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(finish - start).count();
+    std::cout << name << ": " << ns / static_cast<double>(rounds * size) << " ns/element"
+              << " (checksum " << checksum << ")\n";
+}
+
+template <typename Allocator>
+void Compare(const std::string& allocator_name, std::size_t size) {
+    task::List<std::int64_t, Allocator> actual;
+    std::list<std::int64_t, Allocator> expected;
+    for (std::size_t i = 0; i < size; ++i) {
+        actual.PushBack(static_cast<std::int64_t>(i));
+        expected.push_back(static_cast<std::int64_t>(i));
+    }
+
+    Run("task::List<" + allocator_name + ">", actual, size, kTraversedElements / size,
+        [](auto& list) { return Sum(list.Begin(), list.End()); });
+    Run("std::list<" + allocator_name + ">", expected, size, kTraversedElements / size,
+        [](auto& list) { return Sum(list.begin(), list.end()); });
+}
+
+struct Link {
+    Link* next;
+    std::int64_t value;
+};
+
+// Links are bump-allocated from one arena and chained in random order, so every step
+// of the traversal lands on an unrelated page, which is what a long-lived list whose
+// nodes were inserted and erased in arbitrary order looks like.
+void CompareBacking(ArenaBacking backing, const std::string& name) {
+    ArenaOptions options;
+    options.backing = backing;
+    options.bytes = kArenaBytes;
+    CustomAllocator<Link> allocator(options);
+
+    std::size_t size = kArenaBytes / sizeof(Link);
+    std::vector<Link*> links(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        links[i] = allocator.allocate(1);
+        allocator.construct(links[i], nullptr, static_cast<std::int64_t>(i));
+    }
+    std::shuffle(links.begin(), links.end(), std::mt19937_64(42));
+    for (std::size_t i = 0; i + 1 < size; ++i) {
+        links[i]->next = links[i + 1];
+    }
+    Link* head = links.front();
+    links.clear();
+    links.shrink_to_fit();
+
+    std::string label = name;
+    if (allocator.GetArena()->GetBacking() != backing) {
+        label += " (fell back to heap)";
+    }
+    Run("random traversal, " + label, head, size, kRandomRounds, [](Link* link) {
+        std::int64_t sum = 0;
+        for (; link != nullptr; link = link->next) {
+            sum += link->value;
+        }
+        return sum;
+    });
+}
+
+}  // namespace
+
+int main() {
+    Compare<std::allocator<std::int64_t>>("std::allocator", kStdElements);
+    Compare<CustomAllocator<std::int64_t>>("CustomAllocator", kCustomElements);
+    CompareBacking(ArenaBacking::kHeap, "heap arena");
+    CompareBacking(ArenaBacking::kHugePages, "huge page arena");
+    return 0;
+}
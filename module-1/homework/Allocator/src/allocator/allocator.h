@@ -1,6 +1,124 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <new>
 #include <type_traits>
 
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+enum class ArenaBacking {
+    // Plain ::operator new.
+    kHeap,
+    // Anonymous mmap aligned to 2 MiB and marked MADV_HUGEPAGE, so node traversals
+    // touch one TLB entry per 2 MiB instead of per 4 KiB. Falls back to kHeap when
+    // mmap is unavailable.
+    kHugePages,
+};
+
+struct ArenaOptions {
+    ArenaBacking backing = ArenaBacking::kHeap;
+    // 0 keeps the allocator's default of kDefaultSize elements.
+    std::size_t bytes = 0;
+    // Binds kHugePages memory to this NUMA node, -1 leaves placement to the kernel.
+    // Binding failures are ignored, the memory is still usable.
+    int numa_node = -1;
+};
+
+// Bump arena shared by all copies and rebinds of a CustomAllocator.
+class Arena {
+public:
+    static const std::size_t kHugePageSize{std::size_t{2} << 20};
+
+    Arena(std::size_t bytes, const ArenaOptions& options) : size_(bytes) {
+        if (options.backing == ArenaBacking::kHugePages) {
+            MapHugePages(options.numa_node);
+        }
+        if (memory_ == nullptr) {
+            memory_ = ::operator new(size_);
+            backing_ = ArenaBacking::kHeap;
+        }
+    }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    ~Arena() {
+#ifdef __linux__
+        if (backing_ == ArenaBacking::kHugePages) {
+            munmap(mapping_, mapping_size_);
+            return;
+        }
+#endif
+        ::operator delete(memory_);
+    }
+
+    void* Allocate(std::size_t bytes, std::size_t alignment) {
+        std::size_t begin = (offset_ + alignment - 1) & ~(alignment - 1);
+        if (begin > size_ || bytes > size_ - begin) {
+            throw std::bad_alloc();
+        }
+        offset_ = begin + bytes;
+        return static_cast<char*>(memory_) + begin;
+    }
+
+    ArenaBacking GetBacking() const {
+        return backing_;
+    }
+
+    std::size_t GetSize() const {
+        return size_;
+    }
+
+    std::size_t GetUsed() const {
+        return offset_;
+    }
+
+    std::size_t num_allocators{1};
+
+private:
+    void MapHugePages(int numa_node) {
+#ifdef __linux__
+        // Over-map by one huge page so the arena can start on a 2 MiB boundary,
+        // otherwise the kernel can only back the aligned middle with huge pages.
+        std::size_t size = (size_ + kHugePageSize - 1) & ~(kHugePageSize - 1);
+        mapping_size_ = size + kHugePageSize;
+        void* mapping = mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapping == MAP_FAILED) {
+            return;
+        }
+        mapping_ = mapping;
+        auto address = reinterpret_cast<std::uintptr_t>(mapping);
+        memory_ = reinterpret_cast<void*>((address + kHugePageSize - 1) & ~(kHugePageSize - 1));
+        backing_ = ArenaBacking::kHugePages;
+
+#ifdef MADV_HUGEPAGE
+        madvise(memory_, size, MADV_HUGEPAGE);
+#endif
+        if (numa_node >= 0 && numa_node < static_cast<int>(8 * sizeof(unsigned long))) {
+            unsigned long node_mask = 1UL << numa_node;
+            syscall(SYS_mbind, memory_, size, MPOL_BIND, &node_mask, 8 * sizeof(node_mask), 0);
+        }
+#else
+        (void)numa_node;
+#endif
+    }
+
+    void* memory_{nullptr};
+    std::size_t size_;
+    std::size_t offset_{0};
+    ArenaBacking backing_{ArenaBacking::kHeap};
+    void* mapping_{nullptr};
+    std::size_t mapping_size_{0};
+};
+
 template <typename T>
 class CustomAllocator {
 public:
@@ -16,46 +134,43 @@ public:
     using value_type = T;
     // Your code goes here
 
-    CustomAllocator() = default;
+    CustomAllocator() : CustomAllocator(ArenaOptions()) {
+    }
 
-    CustomAllocator(const CustomAllocator& other) noexcept
-        : arena_{other.arena_}, arena_offset_{other.arena_offset_}, num_(other.num_) {
-        ++(*num_);
+    explicit CustomAllocator(const ArenaOptions& options)
+        : arena_{new Arena(options.bytes ? options.bytes : kDefaultSize * sizeof(value_type),
+                           options)} {
     }
 
-    ~CustomAllocator() {
-        --(*num_);
-        if ((*num_) == 0) {
-            ::operator delete(arena_);
-            delete arena_offset_;
-            delete num_;
-        }
+    CustomAllocator(const CustomAllocator& other) noexcept : arena_{other.arena_} {
+        ++arena_->num_allocators;
     }
 
-    template <typename U>
-    explicit CustomAllocator(const CustomAllocator<U>& other) noexcept
-        : arena_{other.GetArena()},
-          arena_offset_{other.GetArenaOffset()},
-          num_(other.GetNumAllocators()) {
-        ++(*num_);
+    CustomAllocator& operator=(const CustomAllocator& other) noexcept {
+        if (arena_ != other.arena_) {
+            Release();
+            arena_ = other.arena_;
+            ++arena_->num_allocators;
+        }
+        return *this;
     }
 
-    void* GetArena() const {
-        return arena_;
+    ~CustomAllocator() {
+        Release();
     }
 
-    size_t* GetArenaOffset() const {
-        return arena_offset_;
+    template <typename U>
+    explicit CustomAllocator(const CustomAllocator<U>& other) noexcept
+        : arena_{other.GetArena()} {
+        ++arena_->num_allocators;
     }
 
-    size_t* GetNumAllocators() const {
-        return num_;
+    Arena* GetArena() const {
+        return arena_;
     }
 
     T* allocate(size_t n) {  // NOLINT
-        pointer next_address = static_cast<pointer>(arena_) + *arena_offset_;
-        *arena_offset_ += n;
-        return next_address;
+        return static_cast<pointer>(arena_->Allocate(n * sizeof(value_type), alignof(value_type)));
     }
     void deallocate(T* p, size_t n){
         // NOLINT
@@ -74,10 +189,15 @@ public:
     friend bool operator!=(const CustomAllocator<K>& lhs, const CustomAllocator<U>& rhs) noexcept;
 
 private:
+    void Release() {
+        --arena_->num_allocators;
+        if (arena_->num_allocators == 0) {
+            delete arena_;
+        }
+    }
+
     static const std::size_t kDefaultSize{20000};
-    void* arena_{::operator new(kDefaultSize * sizeof(value_type))};
-    std::size_t* arena_offset_{new std::size_t(0)};
-    std::size_t* num_{new std::size_t{1}};
+    Arena* arena_;
 };
 
 template <typename T, typename U>
@@ -88,4 +208,4 @@ bool operator==(const CustomAllocator<T>& lhs, const CustomAllocator<U>& rhs) no
 template <typename T, typename U>
 bool operator!=(const CustomAllocator<T>& lhs, const CustomAllocator<U>& rhs) noexcept {
     return !(lhs == rhs);
-}
\ No newline at end of file
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+// Fixed buffer meant to live on the caller's stack. Requests are bump-allocated from
+// the buffer; once it is exhausted they go straight to the global heap, block by block,
+// so containers that fit into N bytes never touch the heap and larger ones keep
+// reusing freed memory.
+template <std::size_t N>
+class InlineArena {
+public:
+    InlineArena() = default;
+    InlineArena(const InlineArena&) = delete;
+    InlineArena& operator=(const InlineArena&) = delete;
+
+    void* Allocate(std::size_t bytes, std::size_t alignment) {
+        std::size_t begin = (offset_ + alignment - 1) & ~(alignment - 1);
+        if (begin + bytes <= N) {
+            offset_ = begin + bytes;
+            return buffer_ + begin;
+        }
+        void* p = ::operator new(bytes, std::align_val_t(alignment));
+        uses_fallback_ = true;
+        fallback_bytes_ += bytes;
+        return p;
+    }
+
+    void Deallocate(void* p, std::size_t bytes, std::size_t alignment) {
+        if (!Owns(p)) {
+            ::operator delete(p, bytes, std::align_val_t(alignment));
+            fallback_bytes_ -= bytes;
+            return;
+        }
+        // Only the most recent block can be given back, which covers the
+        // push/pop pattern of short-lived lists.
+        if (static_cast<unsigned char*>(p) + bytes == buffer_ + offset_) {
+            offset_ = static_cast<unsigned char*>(p) - buffer_;
+        }
+    }
+
+    bool Owns(const void* p) const {
+        auto address = static_cast<const unsigned char*>(p);
+        return buffer_ <= address && address < buffer_ + N;
+    }
+
+    std::size_t GetUsed() const {
+        return offset_;
+    }
+
+    bool UsesFallback() const {
+        return uses_fallback_;
+    }
+
+    // Bytes currently taken from the heap, freed blocks go straight back to it.
+    std::size_t GetFallbackBytes() const {
+        return fallback_bytes_;
+    }
+
+private:
+    alignas(std::max_align_t) unsigned char buffer_[N];
+    std::size_t offset_ = 0;
+    bool uses_fallback_ = false;
+    std::size_t fallback_bytes_ = 0;
+};
+
+template <typename T, std::size_t N>
+class InlineAllocator {
+public:
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    template <typename U>
+    struct rebind {  // NOLINT
+        using other = InlineAllocator<U, N>;
+    };
+
+    using pointer = T*;
+    using value_type = T;
+
+    explicit InlineAllocator(InlineArena<N>& arena) noexcept : arena_(&arena) {
+    }
+
+    template <typename U>
+    InlineAllocator(const InlineAllocator<U, N>& other) noexcept  // NOLINT
+        : arena_(other.GetArena()) {
+    }
+
+    InlineArena<N>* GetArena() const {
+        return arena_;
+    }
+
+    T* allocate(size_t n) {  // NOLINT
+        return static_cast<T*>(arena_->Allocate(n * sizeof(T), alignof(T)));
+    }
+    void deallocate(T* p, size_t n) {  // NOLINT
+        arena_->Deallocate(p, n * sizeof(T), alignof(T));
+    }
+
+private:
+    InlineArena<N>* arena_;
+};
+
+template <typename T, typename U, std::size_t N>
+bool operator==(const InlineAllocator<T, N>& lhs, const InlineAllocator<U, N>& rhs) noexcept {
+    return lhs.GetArena() == rhs.GetArena();
+}
+
+template <typename T, typename U, std::size_t N>
+bool operator!=(const InlineAllocator<T, N>& lhs, const InlineAllocator<U, N>& rhs) noexcept {
+    return !(lhs == rhs);
+}
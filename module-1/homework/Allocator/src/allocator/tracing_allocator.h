@@ -0,0 +1,306 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <unordered_map>
+
+enum class TraceMode {
+    // Only the atomic counters below are maintained, every call costs a few relaxed RMWs.
+    kCounters,
+    // Additionally every sample_period-th allocation is tracked until it is freed,
+    // feeding the size and lifetime histograms and the per-type breakdown.
+    kSampled,
+};
+
+// Shared by all copies and rebinds of a TracingAllocator, so one tracker describes
+// everything a single container (or any other call site owning the allocator) requested.
+class AllocationTracker {
+public:
+    // Bucket i holds values in [2^(i-1), 2^i), bucket 0 holds zero.
+    static const std::size_t kBuckets{64};
+    using Histogram = std::array<std::size_t, kBuckets>;
+
+    struct TypeStats {
+        std::size_t allocations = 0;
+        std::size_t bytes = 0;
+    };
+
+    explicit AllocationTracker(std::string name, TraceMode mode = TraceMode::kCounters,
+                               std::size_t sample_period = 1)
+        : name_(std::move(name)), mode_(mode), sample_period_(sample_period ? sample_period : 1) {
+    }
+
+    AllocationTracker(const AllocationTracker&) = delete;
+    AllocationTracker& operator=(const AllocationTracker&) = delete;
+
+    void OnAllocate(const void* p, std::size_t bytes, const char* type) {
+        std::size_t index = allocations_.fetch_add(1, std::memory_order_relaxed);
+        total_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+        std::size_t in_use = bytes_in_use_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        std::size_t peak = peak_bytes_.load(std::memory_order_relaxed);
+        while (in_use > peak &&
+               !peak_bytes_.compare_exchange_weak(peak, in_use, std::memory_order_relaxed)) {
+        }
+
+        if (mode_ == TraceMode::kSampled && index % sample_period_ == 0) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            live_samples_[p] = Clock::now();
+            size_histogram_[Bucket(bytes)] += 1;
+            TypeStats& stats = per_type_[type];
+            stats.allocations += 1;
+            stats.bytes += bytes;
+        }
+    }
+
+    void OnDeallocate(const void* p, std::size_t bytes) {
+        deallocations_.fetch_add(1, std::memory_order_relaxed);
+        bytes_in_use_.fetch_sub(bytes, std::memory_order_relaxed);
+
+        if (mode_ == TraceMode::kSampled) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = live_samples_.find(p);
+            if (it != live_samples_.end()) {
+                auto lifetime = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    Clock::now() - it->second);
+                lifetime_histogram_[Bucket(static_cast<std::size_t>(lifetime.count()))] += 1;
+                live_samples_.erase(it);
+            }
+        }
+    }
+
+    const std::string& GetName() const {
+        return name_;
+    }
+
+    TraceMode GetMode() const {
+        return mode_;
+    }
+
+    std::size_t GetAllocations() const {
+        return allocations_.load(std::memory_order_relaxed);
+    }
+
+    std::size_t GetDeallocations() const {
+        return deallocations_.load(std::memory_order_relaxed);
+    }
+
+    std::size_t GetTotalBytes() const {
+        return total_bytes_.load(std::memory_order_relaxed);
+    }
+
+    std::size_t GetBytesInUse() const {
+        return bytes_in_use_.load(std::memory_order_relaxed);
+    }
+
+    std::size_t GetPeakBytes() const {
+        return peak_bytes_.load(std::memory_order_relaxed);
+    }
+
+    Histogram GetSizeHistogram() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return size_histogram_;
+    }
+
+    // Lifetimes are in nanoseconds, only samples that have already been freed are counted.
+    Histogram GetLifetimeHistogram() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return lifetime_histogram_;
+    }
+
+    std::map<std::string, TypeStats> GetPerTypeStats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return per_type_;
+    }
+
+    std::string ToJson() const {
+        std::ostringstream out;
+        out << "{\"name\":";
+        WriteString(out, name_);
+        out << ",\"mode\":\"" << (mode_ == TraceMode::kCounters ? "counters" : "sampled") << "\""
+            << ",\"allocations\":" << GetAllocations()
+            << ",\"deallocations\":" << GetDeallocations()
+            << ",\"total_bytes\":" << GetTotalBytes() << ",\"bytes_in_use\":" << GetBytesInUse()
+            << ",\"peak_bytes\":" << GetPeakBytes();
+
+        if (mode_ == TraceMode::kSampled) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            out << ",\"sample_period\":" << sample_period_;
+            out << ",\"size_histogram\":";
+            WriteHistogram(out, size_histogram_);
+            out << ",\"lifetime_ns_histogram\":";
+            WriteHistogram(out, lifetime_histogram_);
+            out << ",\"types\":{";
+            bool first = true;
+            for (const auto& [type, stats] : per_type_) {
+                out << (first ? "" : ",");
+                WriteString(out, type);
+                out << ":{\"allocations\":" << stats.allocations << ",\"bytes\":" << stats.bytes
+                    << "}";
+                first = false;
+            }
+            out << "}";
+        }
+        out << "}";
+        return out.str();
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    static std::size_t Bucket(std::size_t value) {
+        std::size_t bucket = 0;
+        while (value != 0 && bucket + 1 < kBuckets) {
+            value >>= 1;
+            ++bucket;
+        }
+        return bucket;
+    }
+
+    // Names and mangled type names may hold quotes, backslashes or control characters.
+    static void WriteString(std::ostringstream& out, const std::string& value) {
+        out << '"';
+        for (char c : value) {
+            switch (c) {
+                case '"':
+                    out << "\\\"";
+                    break;
+                case '\\':
+                    out << "\\\\";
+                    break;
+                case '\n':
+                    out << "\\n";
+                    break;
+                case '\t':
+                    out << "\\t";
+                    break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        static const char kHex[] = "0123456789abcdef";
+                        out << "\\u00" << kHex[(c >> 4) & 0xf] << kHex[c & 0xf];
+                    } else {
+                        out << c;
+                    }
+                    break;
+            }
+        }
+        out << '"';
+    }
+
+    // Emitted sparsely as {"<bucket upper bound>": count} to keep dumps readable.
+    static void WriteHistogram(std::ostringstream& out, const Histogram& histogram) {
+        out << "{";
+        bool first = true;
+        for (std::size_t i = 0; i < kBuckets; ++i) {
+            if (histogram[i] == 0) {
+                continue;
+            }
+            std::size_t bound = i == 0 ? 0 : (std::size_t{1} << (i - 1)) * 2 - 1;
+            out << (first ? "" : ",") << "\"" << bound << "\":" << histogram[i];
+            first = false;
+        }
+        out << "}";
+    }
+
+    const std::string name_;
+    const TraceMode mode_;
+    const std::size_t sample_period_;
+
+    std::atomic<std::size_t> allocations_{0};
+    std::atomic<std::size_t> deallocations_{0};
+    std::atomic<std::size_t> total_bytes_{0};
+    std::atomic<std::size_t> bytes_in_use_{0};
+    std::atomic<std::size_t> peak_bytes_{0};
+
+    mutable std::mutex mutex_;
+    // Start time of every sampled allocation that has not been freed yet
+    std::unordered_map<const void*, Clock::time_point> live_samples_;
+    Histogram size_histogram_{};
+    Histogram lifetime_histogram_{};
+    std::map<std::string, TypeStats> per_type_;
+};
+
+// Wraps any allocator (CustomAllocator, std::allocator, ...) and reports every
+// allocate/deallocate to a shared AllocationTracker before forwarding to Inner.
+template <typename T, typename Inner = std::allocator<T>>
+class TracingAllocator {
+private:
+    using InnerTraits = std::allocator_traits<Inner>;
+
+public:
+    using propagate_on_container_move_assignment =
+        typename InnerTraits::propagate_on_container_move_assignment;
+    using propagate_on_container_copy_assignment =
+        typename InnerTraits::propagate_on_container_copy_assignment;
+    using propagate_on_container_swap = typename InnerTraits::propagate_on_container_swap;
+    template <typename U>
+    struct rebind {  // NOLINT
+        using other = TracingAllocator<U, typename InnerTraits::template rebind_alloc<U>>;
+    };
+
+    using pointer = T*;
+    using value_type = T;
+
+    TracingAllocator() : tracker_(std::make_shared<AllocationTracker>(typeid(T).name())) {
+    }
+
+    explicit TracingAllocator(std::shared_ptr<AllocationTracker> tracker,
+                              const Inner& inner = Inner())
+        : inner_(inner), tracker_(std::move(tracker)) {
+    }
+
+    template <typename U, typename OtherInner>
+    TracingAllocator(const TracingAllocator<U, OtherInner>& other) noexcept  // NOLINT
+        : inner_(other.GetInner()), tracker_(other.GetTracker()) {
+    }
+
+    const Inner& GetInner() const {
+        return inner_;
+    }
+
+    const std::shared_ptr<AllocationTracker>& GetTracker() const {
+        return tracker_;
+    }
+
+    T* allocate(size_t n) {  // NOLINT
+        T* p = InnerTraits::allocate(inner_, n);
+        tracker_->OnAllocate(p, n * sizeof(T), typeid(T).name());
+        return p;
+    }
+    void deallocate(T* p, size_t n) {  // NOLINT
+        tracker_->OnDeallocate(p, n * sizeof(T));
+        InnerTraits::deallocate(inner_, p, n);
+    }
+    template <typename U, typename... Args>
+    void construct(U* p, Args&&... args) {  // NOLINT
+        InnerTraits::construct(inner_, p, std::forward<Args>(args)...);
+    }
+    template <typename U>
+    void destroy(U* p) {  // NOLINT
+        InnerTraits::destroy(inner_, p);
+    }
+
+private:
+    Inner inner_;
+    std::shared_ptr<AllocationTracker> tracker_;
+};
+
+template <typename T, typename InnerT, typename U, typename InnerU>
+bool operator==(const TracingAllocator<T, InnerT>& lhs,
+                const TracingAllocator<U, InnerU>& rhs) noexcept {
+    return lhs.GetTracker() == rhs.GetTracker() && lhs.GetInner() == rhs.GetInner();
+}
+
+template <typename T, typename InnerT, typename U, typename InnerU>
+bool operator!=(const TracingAllocator<T, InnerT>& lhs,
+                const TracingAllocator<U, InnerU>& rhs) noexcept {
+    return !(lhs == rhs);
+}
@@ -2,23 +2,31 @@
 
 #include <list>
 #include <memory>
+#include <set>
 #include <type_traits>
 
 namespace task {
 template <typename T, typename Allocator = std::allocator<T>>
 class List {
 private:
-    struct Node {
-        Node* prev;
-        Node* next;
+    // The list is circular around sentinel_: sentinel_.next is the first element,
+    // sentinel_.prev is the last one and End() points at the sentinel itself,
+    // so no link is ever nullptr and iterators never need to special-case the ends.
+    struct NodeBase {
+        NodeBase* prev;
+        NodeBase* next;
+    };
+
+    struct Node : NodeBase {
         T value;
 
-        Node(Node* prev, Node* next, const T& value) : prev(prev), next(next), value(value) {
+        template <typename... Args>
+        explicit Node(Args&&... args)
+            : NodeBase{nullptr, nullptr}, value(std::forward<Args>(args)...) {
         }
     };
 
-    Node* head_ = nullptr;
-    Node* tail_ = nullptr;
+    NodeBase sentinel_{&sentinel_, &sentinel_};
 
 public:
     class Iterator {
@@ -30,23 +38,16 @@ public:
         using reference = value_type&;
 
         Iterator() = delete;
-        explicit Iterator(Node* node, bool end = false) : node_(node), end_(end) {
+        explicit Iterator(NodeBase* node) : node_(node) {
         }
 
         Iterator& operator++() {
-            if (node_->next == nullptr) {
-                end_ = true;
-            } else {
-                node_ = node_->next;
-            }
+            node_ = node_->next;
             return *this;
         }
 
         Iterator& operator--() {
-            if (!end_) {
-                node_ = node_->prev;
-            }
-            end_ = false;
+            node_ = node_->prev;
             return *this;
         }
 
@@ -63,30 +64,23 @@ public:
         }
 
         pointer operator->() const {
-            if (end_) {
-                throw std::runtime_error("End iterator");
-            }
-            return &node_->value;
+            return &static_cast<Node*>(node_)->value;
         }
 
         reference operator*() const {
-            if (end_) {
-                throw std::runtime_error("End iterator");
-            }
-            return node_->value;
+            return static_cast<Node*>(node_)->value;
         }
 
-        bool operator==(const Iterator& other) {
-            return node_ == other.node_ && end_ == other.end_;
+        bool operator==(const Iterator& other) const {
+            return node_ == other.node_;
         }
 
-        bool operator!=(const Iterator& other) {
+        bool operator!=(const Iterator& other) const {
             return !(*this == other);
         }
 
     private:
-        Node* node_;
-        bool end_;
+        NodeBase* node_;
     };
 
 public:
@@ -100,45 +94,31 @@ public:
     using propagate_on_container_swap = std::true_type;
 
     typedef typename std::allocator_traits<Allocator>::template rebind_alloc<Node> node_allocator;
+    typedef std::allocator_traits<node_allocator> node_traits;
 
     // List variables
     node_allocator alloc_;
-    // Your code goes here
 
     // Special member functions
     List(){};
+    explicit List(const Allocator& alloc) : alloc_(alloc) {
+    }
 
-    List(const List& other) {
-        size_ = 0;
-        auto tmp = other.head_;
-        while (tmp != other.tail_) {
-            PushBack(tmp->value);
-            tmp = tmp->next;
-        }
-        PushBack(tmp->value);
-    }
-    List(const List& other, const Allocator& alloc) {
-        size_ = 0;
-        auto tmp = other.head_;
-        while (tmp != other.tail_) {
-            PushBack(tmp->value);
-            tmp = tmp->next;
-        }
-        PushBack(tmp->value);
+    List(const List& other)
+        : alloc_(node_traits::select_on_container_copy_construction(other.alloc_)) {
+        Append(other);
+    }
+    List(const List& other, const Allocator& alloc) : alloc_(alloc) {
+        Append(other);
     }
 
-    List(List&& other) {
-        *this = std::move(other);
+    List(List&& other) : alloc_(other.alloc_) {
+        StealFrom(other);
     }
-    List(List&& other, const Allocator& alloc) {
-        alloc_ = alloc;
-        auto tmp = other.head_;
-        while (tmp != other.tail_) {
-            PushBack(std::move(tmp->value));
-            tmp = tmp->next;
+    List(List&& other, const Allocator& alloc) : alloc_(alloc) {
+        for (NodeBase* node = other.sentinel_.next; node != &other.sentinel_; node = node->next) {
+            PushBack(std::move(AsNode(node)->value));
         }
-        PushBack(std::move(tmp->value));
-        size_ = other.Size();
         other.Clear();
     }
 
@@ -147,13 +127,11 @@ public:
     }
 
     List& operator=(const List& other) {
-        Clear();
-        auto tmp = other;
-        while (tmp.head_ != tmp.tail_) {
-            PushBack(tmp.head_->value);
-            tmp.head_ = tmp.head_->next;
+        if (this == &other) {
+            return *this;
         }
-        PushBack(tmp.head_->value);
+        Clear();
+        Append(other);
         return *this;
     }
 
@@ -164,16 +142,11 @@ public:
         Clear();
         if (std::allocator_traits<allocator_type>::propagate_on_container_move_assignment::value) {
             alloc_ = other.alloc_;
-
-            head_ = other.head_;
-            tail_ = other.tail_;
-
-            other.head_ = nullptr;
-            other.tail_ = nullptr;
-            size_ = other.size_;
+            StealFrom(other);
         } else {
-            for (Node* node = other.head_; node != nullptr; node = node->next) {
-                PushBack(std::move(node->value));
+            for (NodeBase* node = other.sentinel_.next; node != &other.sentinel_;
+                 node = node->next) {
+                PushBack(std::move(AsNode(node)->value));
             }
             other.Clear();
         }
@@ -183,31 +156,31 @@ public:
 
     // Element access
     reference Front() {
-        return head_->value;
+        return AsNode(sentinel_.next)->value;
     }
     const_reference Front() const {
-        return head_->value;
+        return AsNode(sentinel_.next)->value;
     }
     reference Back() {
-        return tail_->value;
+        return AsNode(sentinel_.prev)->value;
     }
     const_reference Back() const {
-        return tail_->value;
+        return AsNode(sentinel_.prev)->value;
     }
 
     // Iterators
     iterator Begin() noexcept {
-        return Iterator(head_, head_ == nullptr);
+        return Iterator(sentinel_.next);
     }
     const_iterator Begin() const noexcept {
-        return Iterator(head_, head_ == nullptr);
+        return Iterator(sentinel_.next);
     }
 
     iterator End() noexcept {
-        return Iterator(tail_, true);
+        return Iterator(&sentinel_);
     }
     const_iterator End() const noexcept {
-        return Iterator(tail_, true);
+        return Iterator(const_cast<NodeBase*>(&sentinel_));
     }
 
     // Capacity
@@ -227,14 +200,14 @@ public:
         while (size_ != 0) {
             PopBack();
         }
-        size_ = 0;
     }
     void Swap(List& other) noexcept {
         if (std::allocator_traits<allocator_type>::propagate_on_container_swap::value) {
             std::swap(size_, other.size_);
-            std::swap(head_, other.head_);
-            std::swap(tail_, other.tail_);
+            std::swap(sentinel_, other.sentinel_);
             std::swap(alloc_, other.alloc_);
+            AdoptSentinel();
+            other.AdoptSentinel();
         } else {
             List temp = std::move(other);
             other = std::move(*this);
@@ -243,116 +216,37 @@ public:
     }
 
     void PushBack(const T& value) {
-        Node* node = alloc_.allocate(1);
-        alloc_.construct(node, tail_, nullptr, value);
-
-        if (tail_ != nullptr) {
-            tail_->next = node;
-        }
-        tail_ = node;
-        if (head_ == nullptr) {
-            head_ = node;
-        }
-        size_ += 1;
+        LinkBefore(&sentinel_, CreateNode(value));
     }
     void PushBack(T&& value) {
-        Node* node = alloc_.allocate(1);
-        alloc_.construct(node, tail_, nullptr, std::move(value));
-
-        if (tail_ != nullptr) {
-            tail_->next = node;
-        }
-        tail_ = node;
-        if (head_ == nullptr) {
-            head_ = node;
-        }
-        size_ += 1;
+        LinkBefore(&sentinel_, CreateNode(std::move(value)));
     }
 
     template <typename... Args>
     void EmplaceBack(Args&&... args) {
-        Node* e = alloc_.allocate(1);
-        alloc_.construct(e, tail_, nullptr, std::forward<Args>(args)...);
-
-        if (tail_ != nullptr) {
-            tail_->next = e;
-        }
-        tail_ = e;
-        if (head_ == nullptr) {
-            head_ = e;
-        }
-        size_ += 1;
+        LinkBefore(&sentinel_, CreateNode(std::forward<Args>(args)...));
     }
     void PopBack() {
-        if (tail_ == nullptr) {
-            size_ = 0;
+        if (Empty()) {
             return;
         }
-        Node* node = tail_;
-        tail_ = node->prev;
-        if (tail_ != nullptr) {
-            tail_->next = nullptr;
-        } else {
-            head_ = nullptr;
-        }
-
-        alloc_.destroy(node);
-        alloc_.deallocate(node, 1);
-        size_ -= 1;
+        DestroyNode(Unlink(sentinel_.prev));
     }
     void PushFront(const T& value) {
-        Node* e = alloc_.allocate(1);
-        alloc_.construct(e, nullptr, head_, value);
-
-        if (head_ != nullptr) {
-            head_->prev = e;
-        }
-        head_ = e;
-        if (tail_ == nullptr) {
-            tail_ = e;
-        }
-        size_ += 1;
+        LinkBefore(sentinel_.next, CreateNode(value));
     }
     void PushFront(T&& value) {
-        Node* e = alloc_.allocate(1);
-        alloc_.construct(e, nullptr, head_, value);
-
-        if (head_ != nullptr) {
-            head_->prev = e;
-        }
-        head_ = e;
-        if (tail_ == nullptr) {
-            tail_ = e;
-        }
+        LinkBefore(sentinel_.next, CreateNode(std::move(value)));
     }
     template <typename... Args>
     void EmplaceFront(Args&&... args) {
-        Node* node = alloc_.allocate(1);
-        alloc_.construct(node, nullptr, head_, std::forward<Args>(args)...);
-
-        if (head_ != nullptr) {
-            head_->prev = node;
-        }
-        head_ = node;
-        if (tail_ == nullptr) {
-            tail_ = node;
-        }
+        LinkBefore(sentinel_.next, CreateNode(std::forward<Args>(args)...));
     }
     void PopFront() {
-        if (head_ == nullptr) {
+        if (Empty()) {
             return;
         }
-
-        Node* node = head_;
-        head_ = node->next;
-        if (head_ != nullptr) {
-            head_->prev = nullptr;
-        } else {
-            tail_ = nullptr;
-        }
-
-        alloc_.destroy(node);
-        alloc_.deallocate(node, 1);
+        DestroyNode(Unlink(sentinel_.next));
     }
 
     void Resize(size_type count) {
@@ -370,75 +264,38 @@ public:
 
     // Operations
     void Remove(const T& value) {
-        Node* node = head_;
-
-        while (node != nullptr) {
-            Node* next;
-
-            if (node->value != value) {
-                next = node->next;
-            } else {
-                if (node->prev != nullptr) {
-                    node->prev->next = node->next;
-                }
-                if (node->next != nullptr) {
-                    node->next->prev = node->prev;
-                }
-                if (node == head_) {
-                    head_ = node->next;
-                }
-                if (node == tail_) {
-                    tail_ = node->prev;
-                }
+        NodeBase* node = sentinel_.next;
 
-                next = node->next;
-
-                alloc_.destroy(node);
-                alloc_.deallocate(node, 1);
+        while (node != &sentinel_) {
+            NodeBase* next = node->next;
+            if (AsNode(node)->value == value) {
+                DestroyNode(Unlink(node));
             }
-
             node = next;
         }
     }
     void Unique() {
-        Node* node = head_;
+        NodeBase* node = sentinel_.next;
         std::set<T> els;
 
-        while (node != nullptr) {
-            Node* next;
-
-            if (els.find(node->value) == els.end()) {
-                els.insert(node->value);
-                next = node->next;
+        while (node != &sentinel_) {
+            NodeBase* next = node->next;
+            if (els.find(AsNode(node)->value) == els.end()) {
+                els.insert(AsNode(node)->value);
             } else {
-                node->prev->next = node->next;
-                if (node->next != nullptr) {
-                    node->next->prev = node->prev;
-                }
-                if (node == head_) {
-                    head_ = node->next;
-                }
-                if (node == tail_) {
-                    tail_ = node->prev;
-                }
-
-                next = node->next;
-
-                alloc_.destroy(node);
-                alloc_.deallocate(node, 1);
+                DestroyNode(Unlink(node));
             }
-
             node = next;
         }
     }
     void Sort() {
         size_type size = Size();
         for (size_type i = 0; i < size; ++i) {
-            Node* node = head_;
+            NodeBase* node = sentinel_.next;
 
             for (size_type j = 0; j < size - i - 1; ++j, node = node->next) {
-                if (node->value > node->next->value) {
-                    std::swap(node->value, node->next->value);
+                if (AsNode(node)->value > AsNode(node->next)->value) {
+                    std::swap(AsNode(node)->value, AsNode(node->next)->value);
                 }
             }
         }
@@ -449,8 +306,65 @@ public:
     }
 
 private:
+    static Node* AsNode(NodeBase* node) noexcept {
+        return static_cast<Node*>(node);
+    }
+
+    template <typename... Args>
+    Node* CreateNode(Args&&... args) {
+        Node* node = node_traits::allocate(alloc_, 1);
+        node_traits::construct(alloc_, node, std::forward<Args>(args)...);
+        return node;
+    }
+
+    void DestroyNode(Node* node) {
+        node_traits::destroy(alloc_, node);
+        node_traits::deallocate(alloc_, node, 1);
+    }
+
+    void LinkBefore(NodeBase* pos, NodeBase* node) noexcept {
+        node->next = pos;
+        node->prev = pos->prev;
+        pos->prev->next = node;
+        pos->prev = node;
+        size_ += 1;
+    }
+
+    Node* Unlink(NodeBase* node) noexcept {
+        node->prev->next = node->next;
+        node->next->prev = node->prev;
+        size_ -= 1;
+        return AsNode(node);
+    }
+
+    // After the sentinel has been copied from another list its neighbours still point
+    // at the old sentinel address, so relink them (or self-loop an empty list).
+    void AdoptSentinel() noexcept {
+        if (size_ == 0) {
+            sentinel_.prev = sentinel_.next = &sentinel_;
+        } else {
+            sentinel_.next->prev = &sentinel_;
+            sentinel_.prev->next = &sentinel_;
+        }
+    }
+
+    // Takes over other's nodes, the caller guarantees both lists share an allocator.
+    void StealFrom(List& other) noexcept {
+        sentinel_ = other.sentinel_;
+        size_ = other.size_;
+        AdoptSentinel();
+
+        other.sentinel_.prev = other.sentinel_.next = &other.sentinel_;
+        other.size_ = 0;
+    }
+
+    void Append(const List& other) {
+        for (NodeBase* node = other.sentinel_.next; node != &other.sentinel_; node = node->next) {
+            PushBack(AsNode(node)->value);
+        }
+    }
+
     size_t size_ = 0;
-    // Your code goes here
 };
 
 }  // namespace task
@@ -1,10 +1,13 @@
 #include <algorithm>
 #include <list>
+#include <numeric>
 #include <random>
 #include <string>
 
 #include "gtest/gtest.h"
 #include "src/allocator/allocator.h"
+#include "src/allocator/inline_allocator.h"
+#include "src/allocator/tracing_allocator.h"
 #include "src/list/list.h"
 
 TEST(CopyAssignment, Test) {
@@ -259,6 +262,188 @@ TEST(Mixed, Test1) {
     ASSERT_TRUE(std::equal(actual.Begin(), actual.End(), expected.begin(), expected.end()));
 }
 
+TEST(Iterator, Test1) {
+    using List = task::List<std::string, CustomAllocator<std::string>>;
+    static_assert(sizeof(List::iterator) == sizeof(void*));
+
+    List actual;
+    std::list<std::string, CustomAllocator<std::string>> expected;
+    for (std::size_t i = 0; i < 10; i++) {
+        actual.PushFront(std::to_string(i));
+        expected.push_front(std::to_string(i));
+    }
+    ASSERT_EQ(actual.Size(), expected.size());
+    ASSERT_TRUE(std::equal(std::make_reverse_iterator(actual.End()),
+                           std::make_reverse_iterator(actual.Begin()), expected.rbegin(),
+                           expected.rend()));
+}
+
+TEST(Iterator, Test2) {
+    task::List<int> empty;
+    ASSERT_TRUE(empty.Begin() == empty.End());
+
+    task::List<int> moved;
+    moved.PushBack(1);
+    moved.PushBack(2);
+    task::List<int> target(std::move(moved));
+    ASSERT_TRUE(moved.Begin() == moved.End());
+    ASSERT_EQ(*--target.End(), 2);
+    ASSERT_EQ(*++target.End(), 1);
+}
+
+TEST(TracingAllocator, Test1) {
+    using Allocator = TracingAllocator<std::string, CustomAllocator<std::string>>;
+    auto tracker = std::make_shared<AllocationTracker>("list");
+    {
+        task::List<std::string, Allocator> actual{Allocator(tracker)};
+        std::list<std::string, Allocator> expected(Allocator{tracker});
+        for (std::size_t i = 0; i < 10; i++) {
+            actual.PushBack("hello");
+            expected.push_back("hello");
+        }
+        actual.PopFront();
+        ASSERT_TRUE(std::equal(actual.Begin(), actual.End(), ++expected.begin(), expected.end()));
+        ASSERT_EQ(tracker->GetAllocations(), 20);
+        ASSERT_EQ(tracker->GetDeallocations(), 1);
+    }
+    ASSERT_EQ(tracker->GetAllocations(), tracker->GetDeallocations());
+    ASSERT_EQ(tracker->GetBytesInUse(), 0);
+    ASSERT_GT(tracker->GetPeakBytes(), 0);
+}
+
+TEST(TracingAllocator, Test2) {
+    auto tracker = std::make_shared<AllocationTracker>("sampled", TraceMode::kSampled, 2);
+    std::vector<int, TracingAllocator<int>> vector{TracingAllocator<int>(tracker)};
+    for (int i = 0; i < 100; i++) {
+        vector.push_back(i);
+    }
+    vector.clear();
+    vector.shrink_to_fit();
+
+    auto sizes = tracker->GetSizeHistogram();
+    auto lifetimes = tracker->GetLifetimeHistogram();
+    std::size_t sampled = std::accumulate(sizes.begin(), sizes.end(), std::size_t{0});
+    ASSERT_EQ(sampled, (tracker->GetAllocations() + 1) / 2);
+    ASSERT_EQ(std::accumulate(lifetimes.begin(), lifetimes.end(), std::size_t{0}), sampled);
+
+    std::string json = tracker->ToJson();
+    ASSERT_EQ(json.front(), '{');
+    ASSERT_EQ(json.back(), '}');
+    ASSERT_NE(json.find("\"peak_bytes\":" + std::to_string(tracker->GetPeakBytes())),
+              std::string::npos);
+    ASSERT_NE(json.find("\"size_histogram\""), std::string::npos);
+}
+
+TEST(TracingAllocator, Test3) {
+    auto tracker = std::make_shared<AllocationTracker>("a \"quoted\"\\name\n", TraceMode::kSampled);
+    std::vector<int, TracingAllocator<int>> vector{TracingAllocator<int>(tracker)};
+    vector.push_back(1);
+
+    std::string json = tracker->ToJson();
+    ASSERT_EQ(json.find("{\"name\":\"a \\\"quoted\\\"\\\\name\\n\","), 0);
+    ASSERT_EQ(json.find('\n'), std::string::npos);
+}
+
+TEST(InlineAllocator, Test1) {
+    InlineArena<1024> arena;
+    {
+        task::List<int, InlineAllocator<int, 1024>> actual{InlineAllocator<int, 1024>(arena)};
+        std::list<int> expected;
+        for (int i = 0; i < 32; i++) {
+            actual.PushBack(i);
+            expected.push_back(i);
+        }
+        ASSERT_TRUE(std::equal(actual.Begin(), actual.End(), expected.begin(), expected.end()));
+        ASSERT_FALSE(arena.UsesFallback());
+        ASSERT_GT(arena.GetUsed(), 0);
+    }
+    ASSERT_EQ(arena.GetUsed(), 0);
+}
+
+TEST(InlineAllocator, Test2) {
+    InlineArena<64> arena;
+    task::List<std::string, InlineAllocator<std::string, 64>> actual{
+        InlineAllocator<std::string, 64>(arena)};
+    std::list<std::string> expected;
+    for (std::size_t i = 0; i < 10; i++) {
+        actual.PushBack("hello");
+        expected.push_back("hello");
+    }
+    ASSERT_TRUE(arena.UsesFallback());
+
+    auto moved = std::move(actual);
+    ASSERT_TRUE(actual.Empty());
+    ASSERT_TRUE(std::equal(moved.Begin(), moved.End(), expected.begin(), expected.end()));
+}
+
+TEST(InlineAllocator, Test3) {
+    // Overflows the arena by far more than a CustomAllocator arena could hold, then frees
+    // and refills it: every freed overflow block must be given back to the heap.
+    InlineArena<256> arena;
+    task::List<int, InlineAllocator<int, 256>> actual{InlineAllocator<int, 256>(arena)};
+    std::list<int> expected;
+    std::size_t peak = 0;
+    for (int round = 0; round < 4; round++) {
+        for (int i = 0; i < 50000; i++) {
+            actual.PushBack(i);
+            expected.push_back(i);
+        }
+        ASSERT_TRUE(std::equal(actual.Begin(), actual.End(), expected.begin(), expected.end()));
+        ASSERT_TRUE(arena.UsesFallback());
+        if (round == 0) {
+            peak = arena.GetFallbackBytes();
+        }
+        ASSERT_EQ(arena.GetFallbackBytes(), peak);
+
+        for (int i = 0; i < 25000; i++) {
+            actual.PopBack();
+            expected.pop_back();
+        }
+        ASSERT_LT(arena.GetFallbackBytes(), peak);
+        for (int i = 0; i < 25000; i++) {
+            actual.PushBack(i);
+            expected.push_back(i);
+        }
+        ASSERT_EQ(arena.GetFallbackBytes(), peak);
+        ASSERT_TRUE(std::equal(actual.Begin(), actual.End(), expected.begin(), expected.end()));
+
+        while (!actual.Empty()) {
+            actual.PopBack();
+        }
+        expected.clear();
+        ASSERT_EQ(arena.GetFallbackBytes(), 0);
+        ASSERT_EQ(arena.GetUsed(), 0);
+    }
+}
+
+TEST(CustomAllocator, Test1) {
+    ArenaOptions options;
+    options.backing = ArenaBacking::kHugePages;
+    options.bytes = 4 << 20;
+    options.numa_node = 0;
+    CustomAllocator<std::string> allocator(options);
+    if (allocator.GetArena()->GetBacking() == ArenaBacking::kHugePages) {
+        auto address = reinterpret_cast<std::uintptr_t>(allocator.allocate(1));
+        ASSERT_EQ(address % Arena::kHugePageSize, 0);
+    }
+
+    task::List<std::string, CustomAllocator<std::string>> actual{allocator};
+    std::list<std::string, CustomAllocator<std::string>> expected{allocator};
+    for (std::size_t i = 0; i < 1000; i++) {
+        actual.PushBack("hello");
+        expected.push_back("hello");
+    }
+    ASSERT_TRUE(std::equal(actual.Begin(), actual.End(), expected.begin(), expected.end()));
+}
+
+TEST(CustomAllocator, Test2) {
+    ArenaOptions options;
+    options.bytes = 64;
+    CustomAllocator<std::int64_t> allocator(options);
+    allocator.allocate(8);
+    ASSERT_THROW(allocator.allocate(1), std::bad_alloc);
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
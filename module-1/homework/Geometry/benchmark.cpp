@@ -0,0 +1,120 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "hierarchy/circle.h"
+#include "hierarchy/ellipse.h"
+#include "hierarchy/polygon_locator.h"
+#include "hierarchy/spatial_index.h"
+#include "hierarchy/square.h"
+#include "hierarchy/triangle.h"
+
+namespace {
+
+constexpr size_t kShapes = 200000;
+constexpr double kMapSize = 10000;
+constexpr size_t kLinearQueries = 200;
+constexpr size_t kIndexQueries = 200000;
+constexpr size_t kPolygonVertices = 100000;
+constexpr size_t kPolygonQueries = 2000;
+
+template <typename Query>
+void measure(const std::string& name, const std::vector<Point>& points, size_t queries,
+             Query query) {
+    size_t hits = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < queries; ++i) {
+        hits += query(points[i % points.size()]);
+    }
+    auto finish = std::chrono::steady_clock::now();
+
+    double us = std::chrono::duration<double, std::micro>(finish - start).count();
+    std::cout << name << ": " << us / queries << " us per point (" << hits << " hits in "
+              << queries << " queries)\n";
+}
+
+}  // namespace
+
+// Point location on a map of small triangles, squares, circles and ellipses: a linear
+// scan calling containsPoint on every shape against SpatialIndex::queryPoint. Then
+// repeated queries against one large polygon: Polygon::containsPoint against
+// PolygonLocator.
+int main() {
+    std::mt19937 random(42);
+    std::uniform_real_distribution<double> coordinate(0, kMapSize);
+    std::uniform_real_distribution<double> offset(-10, 10);
+
+    std::vector<std::unique_ptr<Shape>> shapes;
+    for (size_t i = 0; i < kShapes; ++i) {
+        Point a(coordinate(random), coordinate(random));
+        Point b(a.x + offset(random), a.y + offset(random));
+        Point c(a.x + offset(random), a.y + offset(random));
+        switch (i % 4) {
+            case 0:
+                shapes.push_back(std::make_unique<Triangle>(a, b, c));
+                break;
+            case 1:
+                shapes.push_back(std::make_unique<Square>(a, b));
+                break;
+            case 2:
+                shapes.push_back(std::make_unique<Circle>(a, 10));
+                break;
+            default:
+                shapes.push_back(std::make_unique<Ellipse>(a, b, Point::dist(a, b) + 5));
+                break;
+        }
+    }
+    std::vector<const Shape*> pointers;
+    for (const auto& shape : shapes) {
+        pointers.push_back(shape.get());
+    }
+    std::vector<Point> points;
+    for (size_t i = 0; i < kIndexQueries; ++i) {
+        points.emplace_back(coordinate(random), coordinate(random));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    SpatialIndex index(pointers);
+    auto finish = std::chrono::steady_clock::now();
+    std::cout << "SpatialIndex build: "
+              << std::chrono::duration<double, std::milli>(finish - start).count() << " ms for "
+              << kShapes << " shapes\n";
+
+    measure("linear containsPoint", points, kLinearQueries, [&](const Point& point) {
+        size_t hits = 0;
+        for (const Shape* shape : pointers) {
+            hits += shape->containsPoint(point);
+        }
+        return hits;
+    });
+    measure("SpatialIndex::queryPoint", points, kIndexQueries,
+            [&](const Point& point) { return index.queryPoint(point).size(); });
+
+    // A wiggly, non-convex outline with short edges, like a coastline.
+    std::uniform_real_distribution<double> jitter(-0.002, 0.002);
+    std::vector<Point> outline;
+    for (size_t i = 0; i < kPolygonVertices; ++i) {
+        double angle = 2 * PI * i / kPolygonVertices;
+        double wiggle = 0.2 * std::sin(17 * angle) + 0.05 * std::sin(331 * angle);
+        double radius = kMapSize / 2 * (0.7 + wiggle + jitter(random));
+        outline.emplace_back(kMapSize / 2 + radius * std::cos(angle),
+                             kMapSize / 2 + radius * std::sin(angle));
+    }
+    Polygon polygon(outline);
+    start = std::chrono::steady_clock::now();
+    PolygonLocator locator(polygon);
+    finish = std::chrono::steady_clock::now();
+    std::cout << "PolygonLocator build: "
+              << std::chrono::duration<double, std::milli>(finish - start).count() << " ms for "
+              << kPolygonVertices << " vertices\n";
+
+    measure("Polygon::containsPoint", points, kPolygonQueries,
+            [&](const Point& point) { return polygon.containsPoint(point); });
+    measure("PolygonLocator::containsPoint", points, kIndexQueries,
+            [&](const Point& point) { return locator.containsPoint(point); });
+    return 0;
+}
@@ -0,0 +1,32 @@
+#include "bounding_box.h"
+#include <algorithm>
+#include <limits>
+
+BoundingBox::BoundingBox(const Point& min, const Point& max) : min(min), max(max) {}
+
+BoundingBox BoundingBox::empty() {
+    double inf = std::numeric_limits<double>::infinity();
+    return BoundingBox(Point(inf, inf), Point(-inf, -inf));
+}
+
+bool BoundingBox::isEmpty() const {
+    return min.x > max.x || min.y > max.y;
+}
+
+bool BoundingBox::contains(const Point& point) const {
+    return min.x <= point.x && point.x <= max.x && min.y <= point.y && point.y <= max.y;
+}
+
+bool BoundingBox::intersects(const BoundingBox& another) const {
+    return min.x <= another.max.x && another.min.x <= max.x &&
+           min.y <= another.max.y && another.min.y <= max.y;
+}
+
+Point BoundingBox::center() const {
+    return Point((min.x + max.x) / 2, (min.y + max.y) / 2);
+}
+
+void BoundingBox::extend(const BoundingBox& another) {
+    min = Point(std::min(min.x, another.min.x), std::min(min.y, another.min.y));
+    max = Point(std::max(max.x, another.max.x), std::max(max.y, another.max.y));
+}
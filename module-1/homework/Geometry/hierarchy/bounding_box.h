@@ -0,0 +1,17 @@
+#pragma once
+#include "point.h"
+
+// Axis-aligned rectangle, borders included.
+struct BoundingBox {
+    BoundingBox(const Point& min, const Point& max);
+    Point min;
+    Point max;
+
+    // Inverted box that contains and intersects nothing, e.g. of a polygon without vertices.
+    static BoundingBox empty();
+    bool isEmpty() const;
+    bool contains(const Point& point) const;
+    bool intersects(const BoundingBox& another) const;
+    Point center() const;
+    void extend(const BoundingBox& another);
+};
@@ -68,9 +68,23 @@ bool Ellipse::isSimilarTo(const Shape& another) const {
 }
 
 bool Ellipse::containsPoint(const Point& point) const {
-    Point center = this->center();
-    Point shift = point - Vector(center);
-    return Point::dist(shift, F1) + Point::dist(shift, F2) <= dist;
+    return Point::dist(point, F1) + Point::dist(point, F2) <= dist;
+}
+
+BoundingBox Ellipse::boundingBox() const {
+    double majorAxis = dist / 2;
+    double minorAxis = getMinorAxis();
+    double cos = 1;
+    double sin = 0;
+    if (F1 != F2) {
+        Vector direction(F1, F2);
+        direction.normalize();
+        cos = direction.x;
+        sin = direction.y;
+    }
+    Vector halfSize(std::sqrt(std::pow(majorAxis * cos, 2) + std::pow(minorAxis * sin, 2)),
+                    std::sqrt(std::pow(majorAxis * sin, 2) + std::pow(minorAxis * cos, 2)));
+    return BoundingBox(center() - halfSize, center() + halfSize);
 }
 
 void Ellipse::rotate(const Point& center, double angle) {
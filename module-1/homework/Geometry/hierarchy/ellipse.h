@@ -21,6 +21,7 @@ public:
     bool isSimilarTo(const Shape& another) const override;
     bool containsPoint(const Point& point) const override;
     void scale(const Point& center, double scale) override;
+    BoundingBox boundingBox() const override;
 
 protected:
     double dist;
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <utility>
 #include <cmath>
 #include "polygon.h"
@@ -112,15 +113,47 @@ void Polygon::scale(const Point& center, double scale) {
     points = tmp;
 }
 
+// Nonzero winding rule, points on the border count as contained. Unlike a sign test
+// against every edge this is exact for non-convex and self-intersecting polygons.
 bool Polygon::containsPoint(const Point& point) const {
-    for (size_t i = 0; i < points.size() - 1; i++) {
-        Vector a = Vector(points[i], point);
-        Vector b = Vector(points[(i + 1) % points.size()], point);
-        if (Vector::vectorComposition(a, b) == 0 || a * b <= 0) {
+    int winding = 0;
+    for (size_t i = 0; i < points.size(); i++) {
+        const Point& a = points[i];
+        const Point& b = points[(i + 1) % points.size()];
+        if (onSegment(a, b, point)) {
             return true;
         }
+        winding += windingStep(a, b, point);
+    }
+    return winding != 0;
+}
+
+bool Polygon::onSegment(const Point& a, const Point& b, const Point& point) {
+    if (point.x < std::min(a.x, b.x) - EPS || point.x > std::max(a.x, b.x) + EPS ||
+        point.y < std::min(a.y, b.y) - EPS || point.y > std::max(a.y, b.y) + EPS) {
+        return false;
+    }
+    Vector edge(a, b);
+    double lengthSquared = edge * edge;
+    double t = lengthSquared > 0 ? (Vector(a, point) * edge) / lengthSquared : 0;
+    t = std::max(0.0, std::min(1.0, t));
+    return Point::dist(point, a + edge * t) <= EPS;
+}
+
+int Polygon::windingStep(const Point& a, const Point& b, const Point& point) {
+    double side = Vector::vectorComposition(Vector(a, b), Vector(a, point));
+    if (a.y <= point.y) {
+        return b.y > point.y && side > 0 ? 1 : 0;
+    }
+    return b.y <= point.y && side < 0 ? -1 : 0;
+}
+
+BoundingBox Polygon::boundingBox() const {
+    BoundingBox box = BoundingBox::empty();
+    for (const auto& point : points) {
+        box.extend(BoundingBox(point, point));
     }
-    return false;
+    return box;
 }
 
 void Polygon::rotate(const Point& center, double angle) {
@@ -17,11 +17,19 @@ public:
     void reflex(const Point& center) override;
     void reflex(const Line& axis) override;
     void scale(const Point& center, double scale) override;
+    BoundingBox boundingBox() const override;
 
     int verticesCount() const ;
     std::vector<Point> getVertices() const;
     bool isConvex() const;
 
+    // Whether point lies within EPS of the segment [a, b]
+    static bool onSegment(const Point& a, const Point& b, const Point& point);
+    // Change of the winding number around point contributed by the edge a -> b: +1 for
+    // an upward edge passing to the right of point, -1 for a downward one passing to
+    // its left. Only edges whose half-open y-range [min, max) holds point.y count.
+    static int windingStep(const Point& a, const Point& b, const Point& point);
+
 protected:
     std::vector<Point> points;
 };
\ No newline at end of file
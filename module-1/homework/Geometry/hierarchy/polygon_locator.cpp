@@ -0,0 +1,73 @@
+#include "polygon_locator.h"
+#include <algorithm>
+#include <cmath>
+
+PolygonLocator::PolygonLocator(const Polygon& polygon)
+    : points(polygon.getVertices()), box(Point(0, 0), Point(0, 0)), bandHeight(1) {
+    if (points.empty()) {
+        bandStarts = {0, 0};
+        return;
+    }
+    box = polygon.boundingBox();
+    size_t bands = 1;
+    double height = box.max.y - box.min.y;
+    if (height > 0) {
+        double edgeHeights = 0;
+        for (size_t i = 0; i < points.size(); i++) {
+            edgeHeights += std::abs(points[(i + 1) % points.size()].y - points[i].y);
+        }
+        bandHeight = std::max(height, edgeHeights) / points.size();
+        bands = std::min(points.size(), static_cast<size_t>(std::ceil(height / bandHeight)));
+    }
+
+    // Edges within EPS of a band are kept in it too, so border points are found.
+    auto bandRange = [&](size_t edge) {
+        const Point& a = points[edge];
+        const Point& b = points[(edge + 1) % points.size()];
+        return std::make_pair(bandOf(std::min(a.y, b.y) - EPS), bandOf(std::max(a.y, b.y) + EPS));
+    };
+    bandStarts.assign(bands + 1, 0);
+    for (size_t edge = 0; edge < points.size(); edge++) {
+        auto [first, last] = bandRange(edge);
+        for (size_t band = first; band <= last; band++) {
+            bandStarts[band + 1]++;
+        }
+    }
+    for (size_t band = 0; band < bands; band++) {
+        bandStarts[band + 1] += bandStarts[band];
+    }
+    bandEdges.resize(bandStarts.back());
+    std::vector<size_t> filled(bandStarts.begin(), bandStarts.end() - 1);
+    for (size_t edge = 0; edge < points.size(); edge++) {
+        auto [first, last] = bandRange(edge);
+        for (size_t band = first; band <= last; band++) {
+            bandEdges[filled[band]++] = edge;
+        }
+    }
+}
+
+size_t PolygonLocator::bandOf(double y) const {
+    double band = std::floor((y - box.min.y) / bandHeight);
+    double last = static_cast<double>(bandStarts.size() - 2);
+    return static_cast<size_t>(std::max(0.0, std::min(last, band)));
+}
+
+// Edges outside the band neither touch point nor span its y, so they would add
+// nothing to the winding number.
+bool PolygonLocator::containsPoint(const Point& point) const {
+    if (points.empty() || point.x < box.min.x - EPS || point.x > box.max.x + EPS ||
+        point.y < box.min.y - EPS || point.y > box.max.y + EPS) {
+        return false;
+    }
+    size_t band = bandOf(point.y);
+    int winding = 0;
+    for (size_t i = bandStarts[band]; i < bandStarts[band + 1]; i++) {
+        const Point& a = points[bandEdges[i]];
+        const Point& b = points[(bandEdges[i] + 1) % points.size()];
+        if (Polygon::onSegment(a, b, point)) {
+            return true;
+        }
+        winding += Polygon::windingStep(a, b, point);
+    }
+    return winding != 0;
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+#include "bounding_box.h"
+#include "polygon.h"
+
+// Precomputed point-in-polygon test for answering many queries against one large
+// polygon. The bounding box is cut into horizontal bands of equal height, and every
+// band keeps the edges overlapping it. A query picks its band in O(1) and runs the
+// winding-number test over that band's edges only, which for typical polygons is a
+// handful instead of all n. Bands are no lower than the average edge is tall, so all
+// the lists together stay O(n) however long the edges are. Answers match
+// Polygon::containsPoint; the polygon is copied, later changes to it are not seen.
+class PolygonLocator {
+public:
+    explicit PolygonLocator(const Polygon& polygon);
+
+    bool containsPoint(const Point& point) const;
+
+private:
+    size_t bandOf(double y) const;
+
+    std::vector<Point> points;
+    BoundingBox box;
+    double bandHeight;
+    // Edges of band i are bandEdges[bandStarts[i]] .. bandEdges[bandStarts[i + 1] - 1],
+    // edge j being points[j] -> points[(j + 1) % n].
+    std::vector<size_t> bandStarts;
+    std::vector<size_t> bandEdges;
+};
@@ -1,4 +1,5 @@
 #pragma once
+#include "bounding_box.h"
 #include "line.h"
 
 class Shape {
@@ -13,6 +14,8 @@ public:
     virtual void reflex(const Point& center) = 0;
     virtual void reflex(const Line& axis) = 0;
     virtual void scale(const Point& center, double coefficient) = 0;
+    // Smallest axis-aligned box containing every point for which containsPoint is true
+    virtual BoundingBox boundingBox() const = 0;
 
     static Point reflectPoint(const Point& p, const Line& axis);
     static Point reflectPoint(const Point& p, const Point& center);
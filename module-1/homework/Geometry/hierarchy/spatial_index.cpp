@@ -0,0 +1,110 @@
+#include "spatial_index.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace {
+
+// Orders items so that consecutive runs of capacity items are compact tiles: sorted
+// by x into vertical slices of about sqrt(n / capacity) tiles, each slice by y.
+template <typename Item>
+void sortTileRecursive(std::vector<Item>& items, size_t capacity) {
+    size_t tiles = (items.size() + capacity - 1) / capacity;
+    size_t sliceSize = static_cast<size_t>(std::ceil(std::sqrt(tiles))) * capacity;
+    std::sort(items.begin(), items.end(), [](const Item& a, const Item& b) {
+        return a.box.center().x < b.box.center().x;
+    });
+    for (size_t begin = 0; begin < items.size(); begin += sliceSize) {
+        auto end = items.begin() + std::min(begin + sliceSize, items.size());
+        std::sort(items.begin() + begin, end, [](const Item& a, const Item& b) {
+            return a.box.center().y < b.box.center().y;
+        });
+    }
+}
+
+template <typename Item, typename Node>
+std::vector<Node> pack(const std::vector<Item>& items, size_t capacity) {
+    std::vector<Node> nodes;
+    nodes.reserve((items.size() + capacity - 1) / capacity);
+    for (size_t begin = 0; begin < items.size(); begin += capacity) {
+        size_t end = std::min(begin + capacity, items.size());
+        Node node{items[begin].box, begin, end};
+        for (size_t i = begin + 1; i < end; ++i) {
+            node.box.extend(items[i].box);
+        }
+        nodes.push_back(node);
+    }
+    return nodes;
+}
+
+}  // namespace
+
+SpatialIndex::SpatialIndex(const std::vector<const Shape*>& shapes, size_t nodeCapacity) {
+    size_t capacity = std::max<size_t>(nodeCapacity, 2);
+    entries.reserve(shapes.size());
+    for (const Shape* shape : shapes) {
+        // Polygons without vertices contain and intersect nothing, and their
+        // inverted boxes have no center to sort by.
+        BoundingBox box = shape->boundingBox();
+        if (!box.isEmpty()) {
+            entries.push_back(Entry{box, shape});
+        }
+    }
+    if (entries.empty()) {
+        return;
+    }
+
+    sortTileRecursive(entries, capacity);
+    levels.push_back(pack<Entry, Node>(entries, capacity));
+    while (levels.back().size() > 1) {
+        // Reordering a level is safe, its nodes' children are already final.
+        sortTileRecursive(levels.back(), capacity);
+        std::vector<Node> parents = pack<Node, Node>(levels.back(), capacity);
+        levels.push_back(std::move(parents));
+    }
+}
+
+template <typename Visitor>
+void SpatialIndex::visitIntersecting(const BoundingBox& rect, Visitor visitor) const {
+    if (levels.empty()) {
+        return;
+    }
+    std::vector<std::pair<size_t, size_t>> stack = {{levels.size() - 1, 0}};
+    while (!stack.empty()) {
+        auto [level, index] = stack.back();
+        stack.pop_back();
+        const Node& node = levels[level][index];
+        if (!node.box.intersects(rect)) {
+            continue;
+        }
+        for (size_t child = node.begin; child < node.end; ++child) {
+            if (level > 0) {
+                stack.emplace_back(level - 1, child);
+            } else if (entries[child].box.intersects(rect)) {
+                visitor(entries[child].shape);
+            }
+        }
+    }
+}
+
+std::vector<const Shape*> SpatialIndex::queryPoint(const Point& point) const {
+    std::vector<const Shape*> result;
+    // containsPoint accepts points within EPS of the border, while the boxes are exact.
+    Vector margin(EPS, EPS);
+    visitIntersecting(BoundingBox(point - margin, point + margin), [&](const Shape* shape) {
+        if (shape->containsPoint(point)) {
+            result.push_back(shape);
+        }
+    });
+    return result;
+}
+
+std::vector<const Shape*> SpatialIndex::queryRect(const BoundingBox& rect) const {
+    std::vector<const Shape*> result;
+    visitIntersecting(rect, [&](const Shape* shape) { result.push_back(shape); });
+    return result;
+}
+
+size_t SpatialIndex::size() const {
+    return entries.size();
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+#include "bounding_box.h"
+#include "shape.h"
+
+// R-tree over shapes' bounding boxes, bulk-loaded with Sort-Tile-Recursive packing:
+// every node is full except the last one of each level and sibling boxes barely
+// overlap, so a point query visits O(log n) nodes instead of testing every shape.
+// Boxes are taken when the index is built; moving or transforming a shape afterwards
+// requires building a new index. The index does not own the shapes.
+class SpatialIndex {
+public:
+    explicit SpatialIndex(const std::vector<const Shape*>& shapes, size_t nodeCapacity = 16);
+
+    // Shapes whose containsPoint is true for point
+    std::vector<const Shape*> queryPoint(const Point& point) const;
+    // Shapes whose bounding boxes intersect rect
+    std::vector<const Shape*> queryRect(const BoundingBox& rect) const;
+
+    size_t size() const;
+
+private:
+    struct Entry {
+        BoundingBox box;
+        const Shape* shape;
+    };
+
+    // Children are [begin, end) of the level below, or of entries for leaves.
+    struct Node {
+        BoundingBox box;
+        size_t begin;
+        size_t end;
+    };
+
+    template <typename Visitor>
+    void visitIntersecting(const BoundingBox& rect, Visitor visitor) const;
+
+    std::vector<Entry> entries;
+    // levels[0] holds the leaves, levels.back() the single root.
+    std::vector<std::vector<Node>> levels;
+};
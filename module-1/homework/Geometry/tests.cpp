@@ -12,6 +12,8 @@
 #include "hierarchy/circle.h"
 #include "hierarchy/ellipse.h"
 #include "hierarchy/square.h"
+#include "hierarchy/spatial_index.h"
+#include "hierarchy/polygon_locator.h"
 
 #include "gtest/gtest.h"
 
@@ -223,6 +225,24 @@ TEST(ContainsPoint, Test2) {
     ASSERT_TRUE(ellipse.containsPoint(Point(0, 0)));
 }
 
+TEST(ContainsPoint, Test3) {
+    // U shape: the notch between the arms is outside although every edge is close.
+    Polygon u({Point(0, 0), Point(3, 0), Point(3, 3), Point(2, 3), Point(2, 1), Point(1, 1),
+               Point(1, 3), Point(0, 3)});
+    ASSERT_TRUE(u.containsPoint(Point(0.5, 2)));
+    ASSERT_TRUE(u.containsPoint(Point(2.5, 2.5)));
+    ASSERT_TRUE(u.containsPoint(Point(1.5, 1)));
+    ASSERT_TRUE(u.containsPoint(Point(3, 3)));
+    ASSERT_FALSE(u.containsPoint(Point(1.5, 2)));
+    ASSERT_FALSE(u.containsPoint(Point(4, 0)));
+
+    // Same shape listed clockwise.
+    Polygon reversed({Point(0, 3), Point(1, 3), Point(1, 1), Point(2, 1), Point(2, 3),
+                      Point(3, 3), Point(3, 0), Point(0, 0)});
+    ASSERT_TRUE(reversed.containsPoint(Point(0.5, 2)));
+    ASSERT_FALSE(reversed.containsPoint(Point(1.5, 2)));
+}
+
 TEST(Ellipse, Eccentricity) {
     Point a(-1.0, 0.0);
     Point b(1.0, 0.0);
@@ -260,6 +280,119 @@ TEST(Ellipse, Area) {
     ASSERT_NEAR(ellipse.area(), area, 1e-6);
 }
 
+TEST(BoundingBox, Test1) {
+    Ellipse ellipse(Point(-3, 0), Point(3, 0), 10);
+    BoundingBox box = ellipse.boundingBox();
+    ASSERT_TRUE(box.min == Point(-5, -4) && box.max == Point(5, 4));
+
+    Ellipse rotated(Point(0, -3), Point(0, 3), 10);
+    box = rotated.boundingBox();
+    ASSERT_TRUE(box.min == Point(-4, -5) && box.max == Point(4, 5));
+
+    Triangle triangle(Point(1, 2), Point(-1, 0), Point(3, -2));
+    box = triangle.boundingBox();
+    ASSERT_TRUE(box.min == Point(-1, -2) && box.max == Point(3, 2));
+
+    Polygon empty;
+    box = empty.boundingBox();
+    ASSERT_TRUE(box.isEmpty());
+    ASSERT_FALSE(box.intersects(BoundingBox(Point(-100, -100), Point(100, 100))));
+    ASSERT_FALSE(triangle.boundingBox().isEmpty());
+}
+
+TEST(SpatialIndex, Test1) {
+    std::vector<Circle> circles;
+    for (int i = 0; i < 50; ++i) {
+        for (int j = 0; j < 50; ++j) {
+            circles.emplace_back(Point(i * 1.5, j * 1.5), 1 + (i + j) % 3);
+        }
+    }
+    std::vector<const Shape*> shapes;
+    for (const auto& circle : circles) {
+        shapes.push_back(&circle);
+    }
+    SpatialIndex index(shapes, 8);
+    ASSERT_EQ(index.size(), shapes.size());
+
+    for (double x = -2; x < 78; x += 0.7) {
+        for (double y = -2; y < 78; y += 1.3) {
+            Point point(x, y);
+            std::vector<const Shape*> expected;
+            for (const Shape* shape : shapes) {
+                if (shape->containsPoint(point)) {
+                    expected.push_back(shape);
+                }
+            }
+            std::vector<const Shape*> found = index.queryPoint(point);
+            std::sort(expected.begin(), expected.end());
+            std::sort(found.begin(), found.end());
+            ASSERT_EQ(found, expected);
+        }
+    }
+}
+
+TEST(SpatialIndex, Test2) {
+    Triangle triangle(Point(0, 0), Point(4, 0), Point(0, 4));
+    Square square(Point(10, 10), Point(12, 12));
+    Ellipse ellipse(Point(20, 0), Point(26, 0), 10);
+    SpatialIndex index({&triangle, &square, &ellipse});
+
+    ASSERT_EQ(index.queryRect(BoundingBox(Point(3, 3), Point(11, 11))).size(), 2);
+    ASSERT_EQ(index.queryRect(BoundingBox(Point(5, -10), Point(9, 5))).size(), 0);
+    ASSERT_EQ(index.queryRect(BoundingBox(Point(-100, -100), Point(100, 100))).size(), 3);
+
+    std::vector<const Shape*> found = index.queryPoint(Point(23, 1));
+    ASSERT_EQ(found.size(), 1);
+    ASSERT_EQ(found[0], &ellipse);
+    ASSERT_TRUE(index.queryPoint(Point(50, 50)).empty());
+    ASSERT_TRUE(SpatialIndex({}).queryPoint(Point(0, 0)).empty());
+
+    // Points within EPS of the border are contained, even outside the exact bounding box.
+    Square unit(Point(0, 0), Point(1, 1));
+    SpatialIndex border({&unit});
+    found = border.queryPoint(Point(1 + 5e-7, 0.5));
+    ASSERT_EQ(found.size(), 1);
+    ASSERT_EQ(found[0], &unit);
+
+    // A default-constructed polygon is valid input and is never returned.
+    Polygon empty;
+    SpatialIndex withEmpty({&empty, &unit, &triangle});
+    ASSERT_EQ(withEmpty.queryRect(BoundingBox(Point(-100, -100), Point(100, 100))).size(), 2);
+    ASSERT_TRUE(SpatialIndex({&empty}).queryPoint(Point(0, 0)).empty());
+}
+
+TEST(PolygonLocator, Test1) {
+    // Star with long thin spikes, both non-convex and with many vertices.
+    std::vector<Point> star;
+    for (int i = 0; i < 400; ++i) {
+        double angle = 2 * PI * i / 400;
+        double radius = i % 2 == 0 ? 10 : 3 + (i % 7);
+        star.emplace_back(radius * std::cos(angle), radius * std::sin(angle));
+    }
+    Polygon polygon(star);
+    PolygonLocator locator(polygon);
+
+    size_t inside = 0;
+    for (double x = -11; x <= 11; x += 0.173) {
+        for (double y = -11; y <= 11; y += 0.131) {
+            Point point(x, y);
+            ASSERT_EQ(locator.containsPoint(point), polygon.containsPoint(point));
+            inside += polygon.containsPoint(point);
+        }
+    }
+    ASSERT_GT(inside, 0);
+    for (const auto& vertex : star) {
+        ASSERT_TRUE(locator.containsPoint(vertex));
+    }
+
+    // Self-intersecting bow tie, the crossing point is on the border of both halves.
+    Polygon bowTie({Point(0, 0), Point(2, 2), Point(2, 0), Point(0, 2)});
+    PolygonLocator bowTieLocator(bowTie);
+    ASSERT_TRUE(bowTieLocator.containsPoint(Point(1, 1)));
+    ASSERT_TRUE(bowTieLocator.containsPoint(Point(0.2, 1)));
+    ASSERT_FALSE(bowTieLocator.containsPoint(Point(1, 0.2)));
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
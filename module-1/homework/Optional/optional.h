@@ -1,5 +1,10 @@
 #include <cstdlib>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <new>
 #include <type_traits>
+#include <utility>
 
 #pragma once
 
@@ -16,6 +21,13 @@ struct InPlace {
 
 constexpr InPlace kInPlace = InPlace();
 
+// Constructs the value from the result of invoking a function, without a temporary.
+struct InPlaceInvoke {
+    explicit InPlaceInvoke() = default;
+};
+
+constexpr NullOpt kNullOpt = NullOpt(0);
+
 template <typename T, bool = std::is_trivially_destructible_v<T>>
 class DestructHelper;
 
@@ -33,8 +45,9 @@ public:
         : val_(std::forward<Args>(args)...), engaged_(true) {
     }
 
-    template <typename U = T>
-    explicit constexpr DestructHelper(U&& value) : val_(std::forward<U>(value)), engaged_(true) {
+    template <typename F, typename Arg>
+    explicit constexpr DestructHelper(InPlaceInvoke, F&& f, Arg&& arg)
+        : val_(std::invoke(std::forward<F>(f), std::forward<Arg>(arg))), engaged_(true) {
     }
 
     ~DestructHelper() {
@@ -53,14 +66,25 @@ protected:
 
     void Reset() {
         if (engaged_) {
+            val_.~T();
             engaged_ = false;
         }
     }
 
+    // Expects no engaged value.
+    template <typename... Args>
+    void Construct(Args&&... args) {
+        ::new (static_cast<void*>(std::addressof(val_))) T(std::forward<Args>(args)...);
+        engaged_ = true;
+    }
+
     template <typename U = T>
     void Set(U&& value) {
-        val_ = std::forward<U>(value);
-        engaged_ = true;
+        if (engaged_) {
+            val_ = std::forward<U>(value);
+        } else {
+            Construct(std::forward<U>(value));
+        }
     }
 };
 
@@ -78,8 +102,9 @@ public:
         : val_(std::forward<Args>(args)...), engaged_(true) {
     }
 
-    template <typename U = T>
-    explicit constexpr DestructHelper(U&& value) : val_(std::forward<U>(value)), engaged_(true) {
+    template <typename F, typename Arg>
+    explicit constexpr DestructHelper(InPlaceInvoke, F&& f, Arg&& arg)
+        : val_(std::invoke(std::forward<F>(f), std::forward<Arg>(arg))), engaged_(true) {
     }
 
 protected:
@@ -91,28 +116,188 @@ protected:
     bool engaged_;
 
     void Reset() {
-        if (engaged_) {
-            engaged_ = false;
-        }
+        engaged_ = false;
+    }
+
+    // Expects no engaged value.
+    template <typename... Args>
+    void Construct(Args&&... args) {
+        ::new (static_cast<void*>(std::addressof(val_))) T(std::forward<Args>(args)...);
+        engaged_ = true;
     }
 
     template <typename U = T>
     void Set(U&& value) {
-        val_ = std::forward<U>(value);
-        engaged_ = true;
+        if (engaged_) {
+            val_ = std::forward<U>(value);
+        } else {
+            Construct(std::forward<U>(value));
+        }
+    }
+};
+
+// Copy and move members, one class each on top of DestructHelper. A member stays
+// defaulted, and so trivial, whenever the matching members of T are trivial, which
+// keeps Optional of a trivially copyable T trivially copyable (memcpy-able in arrays).
+template <typename T, bool = std::is_trivially_copy_constructible_v<T>>
+class CopyHelper : public DestructHelper<T> {
+public:
+    using DestructHelper<T>::DestructHelper;
+};
+
+template <typename T>
+class CopyHelper<T, false> : public DestructHelper<T> {
+public:
+    using DestructHelper<T>::DestructHelper;
+
+    CopyHelper() = default;
+
+    CopyHelper(const CopyHelper& other) : DestructHelper<T>() {
+        if (other.engaged_) {
+            this->Construct(other.val_);
+        }
     }
+
+    CopyHelper(CopyHelper&&) = default;
+    CopyHelper& operator=(const CopyHelper&) = default;
+    CopyHelper& operator=(CopyHelper&&) = default;
+};
+
+template <typename T, bool = std::is_trivially_move_constructible_v<T>>
+class MoveHelper : public CopyHelper<T> {
+public:
+    using CopyHelper<T>::CopyHelper;
 };
 
 template <typename T>
-class Optional : public DestructHelper<T> {
+class MoveHelper<T, false> : public CopyHelper<T> {
+public:
+    using CopyHelper<T>::CopyHelper;
+
+    MoveHelper() = default;
+    MoveHelper(const MoveHelper&) = default;
+
+    MoveHelper(MoveHelper&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        : CopyHelper<T>() {
+        if (other.engaged_) {
+            this->Construct(std::move(other.val_));
+        }
+    }
+
+    MoveHelper& operator=(const MoveHelper&) = default;
+    MoveHelper& operator=(MoveHelper&&) = default;
+};
+
+template <typename T, bool = std::is_trivially_copy_assignable_v<T> &&
+                             std::is_trivially_copy_constructible_v<T> &&
+                             std::is_trivially_destructible_v<T>>
+class CopyAssignHelper : public MoveHelper<T> {
+public:
+    using MoveHelper<T>::MoveHelper;
+};
+
+template <typename T>
+class CopyAssignHelper<T, false> : public MoveHelper<T> {
+public:
+    using MoveHelper<T>::MoveHelper;
+
+    CopyAssignHelper() = default;
+    CopyAssignHelper(const CopyAssignHelper&) = default;
+    CopyAssignHelper(CopyAssignHelper&&) = default;
+
+    CopyAssignHelper& operator=(const CopyAssignHelper& other) {
+        if (other.engaged_) {
+            this->Set(other.val_);
+        } else {
+            this->Reset();
+        }
+        return *this;
+    }
+
+    CopyAssignHelper& operator=(CopyAssignHelper&&) = default;
+};
+
+template <typename T, bool = std::is_trivially_move_assignable_v<T> &&
+                             std::is_trivially_move_constructible_v<T> &&
+                             std::is_trivially_destructible_v<T>>
+class MoveAssignHelper : public CopyAssignHelper<T> {
+public:
+    using CopyAssignHelper<T>::CopyAssignHelper;
+};
+
+template <typename T>
+class MoveAssignHelper<T, false> : public CopyAssignHelper<T> {
+public:
+    using CopyAssignHelper<T>::CopyAssignHelper;
+
+    MoveAssignHelper() = default;
+    MoveAssignHelper(const MoveAssignHelper&) = default;
+    MoveAssignHelper(MoveAssignHelper&&) = default;
+    MoveAssignHelper& operator=(const MoveAssignHelper&) = default;
+
+    MoveAssignHelper& operator=(MoveAssignHelper&& other) noexcept(
+        std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>) {
+        if (other.engaged_) {
+            this->Set(std::move(other.val_));
+        } else {
+            this->Reset();
+        }
+        return *this;
+    }
+};
+
+// Empty bases that delete Optional's copy members when T cannot be copied, so traits
+// such as std::is_copy_constructible see the truth instead of the helpers above.
+template <bool>
+class EnableCopy {};
+
+template <>
+class EnableCopy<false> {
+public:
+    EnableCopy() = default;
+    EnableCopy(const EnableCopy&) = delete;
+    EnableCopy(EnableCopy&&) = default;
+    EnableCopy& operator=(const EnableCopy&) = default;
+    EnableCopy& operator=(EnableCopy&&) = default;
+};
+
+template <bool>
+class EnableCopyAssign {};
+
+template <>
+class EnableCopyAssign<false> {
+public:
+    EnableCopyAssign() = default;
+    EnableCopyAssign(const EnableCopyAssign&) = default;
+    EnableCopyAssign(EnableCopyAssign&&) = default;
+    EnableCopyAssign& operator=(const EnableCopyAssign&) = delete;
+    EnableCopyAssign& operator=(EnableCopyAssign&&) = default;
+};
+
+template <typename T>
+class Optional;
+
+// Whether U is a value for Optional<T> rather than another Optional or a tag.
+template <typename T, typename U>
+constexpr bool kIsValueArgument = !std::is_same_v<std::decay_t<U>, Optional<T>> &&
+                                  !std::is_same_v<std::decay_t<U>, NullOpt> &&
+                                  !std::is_same_v<std::decay_t<U>, InPlace> &&
+                                  std::is_constructible_v<T, U>;
+
+template <typename T>
+class Optional : public MoveAssignHelper<T>,
+                 private EnableCopy<std::is_copy_constructible_v<T>>,
+                 private EnableCopyAssign<std::is_copy_constructible_v<T> &&
+                                          std::is_copy_assignable_v<T>> {
 public:
     using value_type = T;
-    using base = DestructHelper<T>;
+    using base = MoveAssignHelper<T>;
 
     constexpr Optional() noexcept = default;
 
-    template <typename U = value_type>
-    explicit constexpr Optional(U&& value) : base(std::forward<U>(value)) {
+    template <typename U = value_type,
+              typename = std::enable_if_t<kIsValueArgument<value_type, U>>>
+    explicit constexpr Optional(U&& value) : base(kInPlace, std::forward<U>(value)) {
     }
 
     explicit constexpr Optional(NullOpt) noexcept {
@@ -128,7 +313,7 @@ public:
         return *this;
     }
 
-    template <typename U = T>
+    template <typename U = T, typename = std::enable_if_t<kIsValueArgument<T, U>>>
     Optional& operator=(U&& value) {
         base::Set(std::forward<U>(value));
         return *this;
@@ -138,20 +323,92 @@ public:
         base::Reset();
     }
 
+    // Destroys the current value, if any, and constructs a new one from args directly
+    // in the storage.
+    template <typename... Args>
+    T& Emplace(Args&&... args) {
+        base::Reset();
+        base::Construct(std::forward<Args>(args)...);
+        return base::val_;
+    }
+
     template <typename U>
     constexpr T ValueOr(U&& default_value) const& {
         if (base::engaged_) {
             return base::val_;
         }
-        return default_value;
+        return static_cast<T>(std::forward<U>(default_value));
     }
 
     template <typename U>
     constexpr T ValueOr(U&& default_value) && {
         if (base::engaged_) {
-            return base::val_;
+            return std::move(base::val_);
+        }
+        return static_cast<T>(std::forward<U>(default_value));
+    }
+
+    // Monadic operations. Each one forwards the value with the value category of the
+    // Optional it is called on, so a chain started on an rvalue moves the payload from
+    // stage to stage instead of copying it.
+
+    // f(value), which returns an Optional itself, or an empty one of that type
+    template <typename F>
+    constexpr auto AndThen(F&& f) & {
+        return AndThen(*this, std::forward<F>(f));
+    }
+
+    template <typename F>
+    constexpr auto AndThen(F&& f) const& {
+        return AndThen(*this, std::forward<F>(f));
+    }
+
+    template <typename F>
+    constexpr auto AndThen(F&& f) && {
+        return AndThen(std::move(*this), std::forward<F>(f));
+    }
+
+    template <typename F>
+    constexpr auto AndThen(F&& f) const&& {
+        return AndThen(std::move(*this), std::forward<F>(f));
+    }
+
+    // Optional holding f(value), constructed in place from the call's result
+    template <typename F>
+    constexpr auto Transform(F&& f) & {
+        return Transform(*this, std::forward<F>(f));
+    }
+
+    template <typename F>
+    constexpr auto Transform(F&& f) const& {
+        return Transform(*this, std::forward<F>(f));
+    }
+
+    template <typename F>
+    constexpr auto Transform(F&& f) && {
+        return Transform(std::move(*this), std::forward<F>(f));
+    }
+
+    template <typename F>
+    constexpr auto Transform(F&& f) const&& {
+        return Transform(std::move(*this), std::forward<F>(f));
+    }
+
+    // This Optional if it has a value, f() otherwise
+    template <typename F>
+    constexpr Optional OrElse(F&& f) const& {
+        if (base::engaged_) {
+            return *this;
         }
-        return default_value;
+        return std::forward<F>(f)();
+    }
+
+    template <typename F>
+    constexpr Optional OrElse(F&& f) && {
+        if (base::engaged_) {
+            return std::move(*this);
+        }
+        return std::forward<F>(f)();
     }
 
     constexpr bool HasValue() const noexcept;
@@ -169,6 +426,35 @@ public:
     constexpr const value_type&& operator*() const&&;
 
     constexpr value_type&& operator*() &&;
+
+private:
+    template <typename U>
+    friend class Optional;
+
+    template <typename F, typename Arg>
+    explicit constexpr Optional(InPlaceInvoke tag, F&& f, Arg&& arg)
+        : base(tag, std::forward<F>(f), std::forward<Arg>(arg)) {
+    }
+
+    template <typename Self, typename F>
+    static constexpr auto AndThen(Self&& self, F&& f) {
+        using Result = std::remove_cv_t<
+            std::remove_reference_t<std::invoke_result_t<F, decltype(*std::forward<Self>(self))>>>;
+        if (self.HasValue()) {
+            return std::invoke(std::forward<F>(f), *std::forward<Self>(self));
+        }
+        return Result();
+    }
+
+    template <typename Self, typename F>
+    static constexpr auto Transform(Self&& self, F&& f) {
+        using Result =
+            std::remove_cv_t<std::invoke_result_t<F, decltype(*std::forward<Self>(self))>>;
+        if (self.HasValue()) {
+            return Optional<Result>(InPlaceInvoke(), std::forward<F>(f), *std::forward<Self>(self));
+        }
+        return Optional<Result>();
+    }
 };
 
 template <typename T>
@@ -183,7 +469,7 @@ constexpr Optional<T>::operator bool() const noexcept {
 
 template <typename T>
 constexpr std::add_pointer_t<const T> Optional<T>::operator->() const {
-    return base::val_;
+    return &(base::val_);
 }
 
 template <typename T>
@@ -210,4 +496,185 @@ template <typename T>
 constexpr T&& Optional<T>::operator*() && {
     return std::move(base::val_);
 }
+
+// Optional reference: a pointer that may be null, sized and copied like one. Binds to
+// lvalues only and never owns or copies the referenced object; assigning another
+// reference rebinds instead of assigning through.
+template <typename T>
+class Optional<T&> {
+public:
+    using value_type = T&;
+
+    constexpr Optional() noexcept = default;
+
+    explicit constexpr Optional(NullOpt) noexcept {
+    }
+
+    explicit constexpr Optional(T& ref) noexcept : ptr_(std::addressof(ref)) {
+    }
+
+    Optional(T&&) = delete;
+
+    Optional& operator=(NullOpt) noexcept {
+        Reset();
+        return *this;
+    }
+
+    void Reset() noexcept {
+        ptr_ = nullptr;
+    }
+
+    T& Emplace(T& ref) noexcept {
+        ptr_ = std::addressof(ref);
+        return ref;
+    }
+
+    template <typename U>
+    constexpr std::remove_cv_t<T> ValueOr(U&& default_value) const {
+        if (ptr_ != nullptr) {
+            return *ptr_;
+        }
+        return static_cast<std::remove_cv_t<T>>(std::forward<U>(default_value));
+    }
+
+    template <typename F>
+    constexpr auto AndThen(F&& f) const {
+        using Result = std::remove_cv_t<std::remove_reference_t<std::invoke_result_t<F, T&>>>;
+        if (ptr_ != nullptr) {
+            return std::invoke(std::forward<F>(f), *ptr_);
+        }
+        return Result();
+    }
+
+    template <typename F>
+    constexpr auto Transform(F&& f) const {
+        using Result = std::remove_cv_t<std::invoke_result_t<F, T&>>;
+        if (ptr_ != nullptr) {
+            return Optional<Result>(InPlaceInvoke(), std::forward<F>(f), *ptr_);
+        }
+        return Optional<Result>();
+    }
+
+    template <typename F>
+    constexpr Optional OrElse(F&& f) const {
+        if (ptr_ != nullptr) {
+            return *this;
+        }
+        return std::forward<F>(f)();
+    }
+
+    constexpr bool HasValue() const noexcept {
+        return ptr_ != nullptr;
+    }
+
+    explicit constexpr operator bool() const noexcept {
+        return ptr_ != nullptr;
+    }
+
+    constexpr T* operator->() const {
+        return ptr_;
+    }
+
+    constexpr T& operator*() const {
+        return *ptr_;
+    }
+
+private:
+    template <typename U>
+    friend class Optional;
+
+    template <typename F, typename Arg>
+    explicit constexpr Optional(InPlaceInvoke, F&& f, Arg&& arg)
+        : ptr_(std::addressof(std::invoke(std::forward<F>(f), std::forward<Arg>(arg)))) {
+    }
+
+    T* ptr_ = nullptr;
+};
+
+// Empty states for CompactOptional: a type with static Empty() returning the reserved
+// value and static IsEmpty(value) recognizing it.
+template <typename T, T Value>
+struct SentinelValue {
+    static constexpr T Empty() noexcept {
+        return Value;
+    }
+
+    static constexpr bool IsEmpty(const T& value) noexcept {
+        return value == Value;
+    }
+};
+
+// Floating point values use NaN, which never compares equal to itself.
+template <typename T>
+struct NaNSentinel {
+    static constexpr T Empty() noexcept {
+        return std::numeric_limits<T>::quiet_NaN();
+    }
+
+    static constexpr bool IsEmpty(const T& value) noexcept {
+        return value != value;
+    }
+};
+
+// Optional without the engaged flag: one value of T is reserved to mean "empty", so
+// CompactOptional<T, Sentinel> is exactly as large as T. Storing the reserved value
+// itself is indistinguishable from Reset().
+//
+//     CompactOptional<int32_t, SentinelValue<int32_t, -1>> index;
+//     CompactOptional<double, NaNSentinel<double>> weight;
+template <typename T, typename Sentinel>
+class CompactOptional {
+public:
+    using value_type = T;
+
+    constexpr CompactOptional() noexcept : value_(Sentinel::Empty()) {
+    }
+
+    constexpr CompactOptional(NullOpt) noexcept : value_(Sentinel::Empty()) {  // NOLINT
+    }
+
+    explicit constexpr CompactOptional(const T& value) : value_(value) {
+    }
+
+    CompactOptional& operator=(NullOpt) noexcept {
+        Reset();
+        return *this;
+    }
+
+    CompactOptional& operator=(const T& value) {
+        value_ = value;
+        return *this;
+    }
+
+    void Reset() noexcept {
+        value_ = Sentinel::Empty();
+    }
+
+    template <typename U>
+    constexpr T ValueOr(U&& default_value) const {
+        if (HasValue()) {
+            return value_;
+        }
+        return static_cast<T>(std::forward<U>(default_value));
+    }
+
+    constexpr bool HasValue() const noexcept {
+        return !Sentinel::IsEmpty(value_);
+    }
+
+    explicit constexpr operator bool() const noexcept {
+        return HasValue();
+    }
+
+    constexpr const T* operator->() const {
+        return &value_;
+    }
+
+    constexpr const T& operator*() const {
+        return value_;
+    }
+
+private:
+    T value_;
+};
 }  // namespace task
@@ -1,5 +1,7 @@
 #include <cstdint>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "optional.h"
@@ -40,6 +42,154 @@ TEST(IndirectionOperator, Test1) {
     ASSERT_EQ(*opt, 1);
 }
 
+TEST(Copy, Test1) {
+    static_assert(std::is_trivially_copyable_v<task::Optional<int64_t>>);
+    static_assert(std::is_trivially_destructible_v<task::Optional<int64_t>>);
+    static_assert(!std::is_trivially_copyable_v<task::Optional<std::string>>);
+    static_assert(!std::is_copy_constructible_v<task::Optional<std::unique_ptr<int>>>);
+    static_assert(!std::is_copy_assignable_v<task::Optional<std::unique_ptr<int>>>);
+    static_assert(std::is_move_constructible_v<task::Optional<std::unique_ptr<int>>>);
+    static_assert(std::is_move_assignable_v<task::Optional<std::unique_ptr<int>>>);
+    static_assert(sizeof(task::Optional<int64_t>) == 16);
+
+    task::Optional<std::string> opt("Hello world");
+    task::Optional<std::string> copy(opt);
+    ASSERT_EQ(*copy, "Hello world");
+    task::Optional<std::string> moved(std::move(copy));
+    ASSERT_EQ(*moved, "Hello world");
+
+    task::Optional<std::string> empty;
+    opt = empty;
+    ASSERT_FALSE(opt.HasValue());
+    opt = moved;
+    ASSERT_EQ(*opt, "Hello world");
+    empty = std::move(opt);
+    ASSERT_EQ(*empty, "Hello world");
+    empty = task::kNullOpt;
+    ASSERT_FALSE(empty);
+}
+
+TEST(CompactOptional, Test1) {
+    using Index = task::CompactOptional<int32_t, task::SentinelValue<int32_t, -1>>;
+    using Weight = task::CompactOptional<double, task::NaNSentinel<double>>;
+    using Pointer = task::CompactOptional<const char*, task::SentinelValue<const char*, nullptr>>;
+    static_assert(sizeof(Index) == sizeof(int32_t) && sizeof(Weight) == sizeof(double));
+    static_assert(sizeof(Pointer) == sizeof(const char*));
+    static_assert(std::is_trivially_copyable_v<Weight>);
+
+    Index index;
+    ASSERT_FALSE(index.HasValue());
+    index = 7;
+    ASSERT_EQ(*index, 7);
+    index.Reset();
+    ASSERT_EQ(index.ValueOr(3), 3);
+
+    Weight weight(0.5);
+    ASSERT_TRUE(weight);
+    weight = task::kNullOpt;
+    ASSERT_FALSE(weight);
+
+    Pointer name("Hello world");
+    ASSERT_EQ(std::string(*name), "Hello world");
+}
+
+struct Payload {
+    explicit Payload(size_t size) : data(size, 1) {
+    }
+
+    Payload(const Payload& other) : data(other.data) {
+        ++copies;
+    }
+
+    Payload(Payload&&) noexcept = default;
+    Payload& operator=(const Payload&) = default;
+    Payload& operator=(Payload&&) noexcept = default;
+
+    std::vector<int32_t> data;
+    static inline size_t copies = 0;
+};
+
+TEST(Monadic, Test1) {
+    Payload::copies = 0;
+    task::Optional<Payload> opt(task::kInPlace, 1000);
+    auto sizes = std::move(opt)
+                     .AndThen([](Payload&& p) {
+                         p.data.push_back(2);
+                         return task::Optional<Payload>(std::move(p));
+                     })
+                     .Transform([](Payload&& p) { return std::move(p); })
+                     .Transform([](const Payload& p) { return p.data.size(); });
+    ASSERT_EQ(*sizes, 1001);
+    ASSERT_EQ(Payload::copies, 0);
+
+    task::Optional<std::string> name("Hello world");
+    auto length = name.Transform([](const std::string& s) { return s.size(); });
+    ASSERT_EQ(*length, 11);
+    ASSERT_EQ(*name, "Hello world");
+}
+
+TEST(Monadic, Test2) {
+    task::Optional<std::string> empty;
+    auto length = empty.Transform([](const std::string& s) { return s.size(); });
+    ASSERT_FALSE(length.HasValue());
+    auto half = task::Optional<int32_t>(7).AndThen([](int32_t value) {
+        return value % 2 == 0 ? task::Optional<int32_t>(value / 2) : task::Optional<int32_t>();
+    });
+    ASSERT_FALSE(half);
+
+    auto fallback = empty.OrElse([] { return task::Optional<std::string>("empty"); });
+    ASSERT_EQ(*fallback, "empty");
+    const task::Optional<std::string> name("Hello world");
+    ASSERT_EQ(*name.OrElse([] { return task::Optional<std::string>(); }), "Hello world");
+    ASSERT_EQ(std::move(fallback).ValueOr("unused"), "empty");
+}
+
+TEST(Emplace, Test1) {
+    Payload::copies = 0;
+    task::Optional<Payload> opt;
+    ASSERT_EQ(opt.Emplace(100).data.size(), 100);
+    ASSERT_EQ(opt.Emplace(10).data.size(), 10);
+    ASSERT_EQ(opt->data.size(), 10);
+    ASSERT_EQ(Payload::copies, 0);
+
+    task::Optional<std::string> name;
+    name.Emplace(3, 'a');
+    ASSERT_EQ(*name, "aaa");
+}
+
+TEST(OptionalReference, Test1) {
+    static_assert(sizeof(task::Optional<std::string&>) == sizeof(std::string*));
+    static_assert(std::is_trivially_copyable_v<task::Optional<std::string&>>);
+    static_assert(!std::is_constructible_v<task::Optional<const std::string&>, std::string&&>);
+
+    std::vector<std::string> names = {"first", "second"};
+    auto find = [&](const std::string& name) {
+        for (auto& element : names) {
+            if (element == name) {
+                return task::Optional<std::string&>(element);
+            }
+        }
+        return task::Optional<std::string&>();
+    };
+
+    auto second = find("second");
+    ASSERT_TRUE(second);
+    *second += "!";
+    ASSERT_EQ(names[1], "second!");
+    ASSERT_EQ(&*second, &names[1]);
+    ASSERT_FALSE(find("third").HasValue());
+    ASSERT_EQ(find("third").ValueOr("none"), "none");
+
+    auto& first = *second.Transform([&](std::string&) -> std::string& { return names[0]; });
+    ASSERT_EQ(&first, &names[0]);
+    ASSERT_EQ(*second.Transform([](const std::string& s) { return s.size(); }), 7);
+
+    second.Emplace(names[0]);
+    ASSERT_EQ(second->size(), 5);
+    second.Reset();
+    ASSERT_FALSE(second);
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
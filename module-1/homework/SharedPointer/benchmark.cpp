@@ -0,0 +1,180 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "src/atomic_shared_ptr/atomic_shared_ptr.h"
+#include "src/intrusive_ptr/intrusive_ptr.h"
+#include "src/reclaimer/reclaimer.h"
+#include "src/shared_ptr/shared_ptr.h"
+
+namespace {
+
+constexpr std::size_t kIterations = 1 << 24;
+constexpr std::size_t kSnapshotReads = 1 << 20;
+constexpr std::size_t kObjects = 1 << 20;
+constexpr std::size_t kDereferenceRounds = 16;
+constexpr std::size_t kGraphStrings = 1 << 17;
+constexpr std::size_t kReleases = 16;
+
+// Copies one pointer into a slot and drops whatever was there before, so every
+// iteration costs exactly one increment and one decrement of the same counter.
+template <typename Pointer>
+void Run(const std::string& name, const Pointer& source) {
+    std::vector<Pointer> slots(16);
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < kIterations; ++i) {
+        slots[i % slots.size()] = source;
+        slots[(i + 8) % slots.size()] = Pointer();
+    }
+    auto finish = std::chrono::steady_clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(finish - start).count();
+    std::cout << name << ": " << ns / kIterations << " ns per copy+destroy\n";
+}
+
+struct Boxed : RefCounted<Boxed> {
+    explicit Boxed(std::int64_t value) : value(value) {
+    }
+    std::int64_t value;
+};
+
+// Walks a vector of pointers to separately allocated objects, which is where the
+// pointer's own size shows up: IntrusivePtr is one word, SharedPtr is two.
+template <typename Pointer, typename Make>
+void RunDereference(const std::string& name, Make make) {
+    std::vector<Pointer> pointers;
+    pointers.reserve(kObjects);
+    for (std::size_t i = 0; i < kObjects; ++i) {
+        pointers.push_back(make(static_cast<std::int64_t>(i)));
+    }
+
+    std::int64_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t round = 0; round < kDereferenceRounds; ++round) {
+        for (const auto& pointer : pointers) {
+            checksum += pointer->value;
+        }
+    }
+    auto finish = std::chrono::steady_clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(finish - start).count();
+    std::cout << name << ": " << ns / (kObjects * kDereferenceRounds)
+              << " ns per dereference (checksum " << checksum << ")\n";
+}
+
+using Graph = std::vector<std::string>;
+
+// Time the releasing thread spends dropping the last reference to a large object,
+// which is the latency a request path sees.
+template <typename Make>
+void RunRelease(const std::string& name, Make make) {
+    double total_us = 0;
+    double worst_us = 0;
+    for (std::size_t i = 0; i < kReleases; ++i) {
+        SharedPtr<Graph> graph = make();
+        for (std::size_t j = 0; j < kGraphStrings; ++j) {
+            graph->push_back(std::string(64, 'x'));
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        graph.Reset();
+        auto finish = std::chrono::steady_clock::now();
+
+        double us = std::chrono::duration<double, std::micro>(finish - start).count();
+        total_us += us;
+        worst_us = std::max(worst_us, us);
+    }
+    std::cout << name << ": " << total_us / kReleases << " us average, " << worst_us
+              << " us worst per last-reference release\n";
+}
+
+struct LockedSlot {
+    SharedPtr<std::int64_t> Load() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return value;
+    }
+
+    void Store(SharedPtr<std::int64_t> desired) {
+        std::lock_guard<std::mutex> lock(mutex);
+        value = std::move(desired);
+    }
+
+    std::mutex mutex;
+    SharedPtr<std::int64_t> value = MakeShared<std::int64_t>(0);
+};
+
+// Snapshot publication: every reader loads the current snapshot and reads through it
+// kSnapshotReads times while one writer keeps publishing new snapshots.
+template <typename Slot>
+void RunSnapshots(const std::string& name, Slot& slot, std::size_t readers) {
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        for (std::int64_t i = 1; !done.load(std::memory_order_relaxed); ++i) {
+            slot.Store(MakeShared<std::int64_t>(i));
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    });
+
+    std::vector<std::thread> threads;
+    std::vector<std::int64_t> checksums(readers);
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < readers; ++i) {
+        threads.emplace_back([&, i] {
+            // Summed locally, neighbouring checksums share a cache line.
+            std::int64_t checksum = 0;
+            for (std::size_t j = 0; j < kSnapshotReads; ++j) {
+                checksum += *slot.Load();
+            }
+            checksums[i] = checksum;
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    auto finish = std::chrono::steady_clock::now();
+    done = true;
+    writer.join();
+
+    double seconds = std::chrono::duration<double>(finish - start).count();
+    std::cout << name << ", " << readers
+              << " readers: " << static_cast<double>(readers * kSnapshotReads) / seconds / 1e6
+              << " M loads/s\n";
+}
+
+}  // namespace
+
+int main() {
+    // libstdc++ switches std::shared_ptr to plain arithmetic while the process has a single
+    // thread, starting one keeps the comparison with the atomic policy fair.
+    std::thread([] {}).join();
+
+    Run("std::shared_ptr", std::make_shared<std::int64_t>(42));
+    Run("SharedPtr<AtomicRefCount>", MakeShared<std::int64_t>(42));
+    Run("SharedPtr<NonAtomicRefCount>", MakeLocalShared<std::int64_t>(42));
+    Run("IntrusivePtr<RefCounted<AtomicRefCount>>", MakeIntrusive<Boxed>(42));
+
+    RunDereference<SharedPtr<Boxed>>("SharedPtr<Boxed>",
+                                     [](std::int64_t i) { return SharedPtr<Boxed>(new Boxed(i)); });
+    RunDereference<IntrusivePtr<Boxed>>("IntrusivePtr<Boxed>",
+                                        [](std::int64_t i) { return MakeIntrusive<Boxed>(i); });
+
+    RunRelease("SharedPtr, inline destruction", [] { return SharedPtr<Graph>(new Graph); });
+    RunRelease("SharedPtr, DeferredDelete", [] { return MakeSharedDeferred<Graph>(); });
+
+    std::size_t max_readers = std::max(1u, std::thread::hardware_concurrency());
+    for (std::size_t readers = 1; readers <= max_readers; readers *= 2) {
+        LockedSlot locked;
+        RunSnapshots("mutex + SharedPtr", locked, readers);
+        AtomicSharedPtr<std::int64_t> atomic(MakeShared<std::int64_t>(0));
+        RunSnapshots("AtomicSharedPtr", atomic, readers);
+    }
+    return 0;
+}
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+#include "../shared_ptr/shared_ptr.h"
+
+// A SharedPtr slot that many threads can read and replace without a mutex.
+//
+// The published SharedPtr lives in a heap node, and the slot is a single word
+// holding the node address in the low 48 bits and a count of in-flight readers in
+// the high 16 bits (split reference counting). A reader bumps that count, which pins
+// the node, copies the SharedPtr out of it and then hands its pin back. A writer swaps
+// in a new node and moves the reader count it replaced into the old node's pending
+// counter. Whoever brings that counter to zero deletes the
+// node and with it the old snapshot's strong reference.
+//
+// This assumes user-space addresses fit into 48 bits, as with 4-level paging on x86-64
+// and AArch64. A node allocated above that (e.g. with 5-level paging enabled) makes
+// the constructor and the writers throw std::runtime_error instead of corrupting the slot.
+//
+// Every operation is lock-free: loops only retry when another thread made progress.
+// Stores allocate one node, loads never allocate. Lock-free is not contention-free
+// though: every Load does two CASes on the one shared word, so concurrent readers
+// serialize on its cache line and reads do not scale linearly with cores.
+template <typename T>
+class AtomicSharedPtr {
+public:
+    constexpr AtomicSharedPtr() noexcept = default;
+
+    explicit AtomicSharedPtr(SharedPtr<T> desired) : word_(Pack(MakeNode(std::move(desired)), 0)) {
+    }
+
+    AtomicSharedPtr(const AtomicSharedPtr&) = delete;
+    AtomicSharedPtr& operator=(const AtomicSharedPtr&) = delete;
+
+    ~AtomicSharedPtr() {
+        delete GetNode(word_.load(std::memory_order_relaxed));
+    }
+
+    bool IsLockFree() const noexcept {
+        return word_.is_lock_free();
+    }
+
+    SharedPtr<T> Load() const {
+        Node* node = Acquire();
+        SharedPtr<T> result = node ? node->value : SharedPtr<T>();
+        Release(node);
+        return result;
+    }
+
+    void Store(SharedPtr<T> desired) {
+        Exchange(std::move(desired));
+    }
+
+    SharedPtr<T> Exchange(SharedPtr<T> desired) {
+        std::uintptr_t old = word_.exchange(Pack(MakeNode(std::move(desired)), 0),
+                                            std::memory_order_acq_rel);
+        return Retire(GetNode(old), GetReaders(old));
+    }
+
+    // Replaces the value with desired if it still shares ownership of, and points to,
+    // the same object as expected. Otherwise loads the current value into expected.
+    bool CompareExchange(SharedPtr<T>& expected, SharedPtr<T> desired) {
+        Node* replacement = MakeNode(std::move(desired));
+        while (true) {
+            Node* node = Acquire();
+            if (!Matches(node, expected)) {
+                expected = node ? node->value : SharedPtr<T>();
+                Release(node);
+                delete replacement;
+                return false;
+            }
+
+            std::uintptr_t current = word_.load(std::memory_order_relaxed);
+            while (GetNode(current) == node) {
+                if (word_.compare_exchange_weak(current, Pack(replacement, 0),
+                                                std::memory_order_acq_rel,
+                                                std::memory_order_relaxed)) {
+                    // One of the readers counted in current is this call itself.
+                    Retire(node, GetReaders(current) - 1);
+                    return true;
+                }
+            }
+            // Someone else published in between, start over with the new value.
+            Release(node);
+        }
+    }
+
+private:
+    struct Node {
+        explicit Node(SharedPtr<T> value) : value(std::move(value)) {
+        }
+
+        SharedPtr<T> value;
+        // Readers still holding a pin minus the pins a writer handed over.
+        std::atomic<std::int64_t> pending{0};
+    };
+
+    static_assert(sizeof(std::uintptr_t) == 8, "the reader count lives in the pointer's top bits");
+
+    static const int kReaderShift = 48;
+    static const std::uintptr_t kOneReader = std::uintptr_t{1} << kReaderShift;
+    static const std::uintptr_t kNodeMask = kOneReader - 1;
+
+    static Node* MakeNode(SharedPtr<T> value) {
+        if (!value.control_) {
+            return nullptr;
+        }
+        Node* node = new Node(std::move(value));
+        if (reinterpret_cast<std::uintptr_t>(node) & ~kNodeMask) {
+            delete node;
+            throw std::runtime_error("AtomicSharedPtr: node address does not fit into 48 bits");
+        }
+        return node;
+    }
+
+    static std::uintptr_t Pack(Node* node, std::uintptr_t readers) {
+        return reinterpret_cast<std::uintptr_t>(node) | (readers << kReaderShift);
+    }
+
+    static Node* GetNode(std::uintptr_t word) {
+        return reinterpret_cast<Node*>(word & kNodeMask);
+    }
+
+    static std::uintptr_t GetReaders(std::uintptr_t word) {
+        return word >> kReaderShift;
+    }
+
+    static bool Matches(const Node* node, const SharedPtr<T>& expected) {
+        if (node == nullptr) {
+            return expected.control_ == nullptr;
+        }
+        return node->value.ptr_ == expected.ptr_ && node->value.control_ == expected.control_;
+    }
+
+    // Pins the current node until the matching Release. An empty slot is never pinned,
+    // so a reader count is only ever attached to a node that is still allocated.
+    Node* Acquire() const {
+        std::uintptr_t current = word_.load(std::memory_order_relaxed);
+        while (GetNode(current) != nullptr) {
+            if (word_.compare_exchange_weak(current, current + kOneReader,
+                                            std::memory_order_acquire,
+                                            std::memory_order_relaxed)) {
+                return GetNode(current);
+            }
+        }
+        return nullptr;
+    }
+
+    void Release(Node* node) const {
+        if (node == nullptr) {
+            return;
+        }
+        std::uintptr_t current = word_.load(std::memory_order_relaxed);
+        while (GetNode(current) == node) {
+            // Still published: give the pin back to the slot.
+            if (word_.compare_exchange_weak(current, current - kOneReader,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed)) {
+                return;
+            }
+        }
+        // Replaced while we were reading: the writer moved our pin into pending.
+        if (node->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete node;
+        }
+    }
+
+    // Takes the value out of a node that is no longer published, leaving it to be
+    // deleted by the last of its readers.
+    static SharedPtr<T> Retire(Node* node, std::uintptr_t readers) {
+        if (node == nullptr) {
+            return SharedPtr<T>();
+        }
+        SharedPtr<T> result = node->value;
+        auto handed_over = static_cast<std::int64_t>(readers);
+        if (node->pending.fetch_add(handed_over, std::memory_order_acq_rel) + handed_over == 0) {
+            delete node;
+        }
+        return result;
+    }
+
+    mutable std::atomic<std::uintptr_t> word_{0};
+};
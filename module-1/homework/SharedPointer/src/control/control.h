@@ -1,91 +1,417 @@
 #pragma once
 
 #include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
 
+#include "../instrumentation/instrumentation.h"
+
+// Observation points every policy provides, all of them no-ops unless overridden
+// (see InstrumentedRefCount). Blocks are identified by their ControlBlockBase address.
+struct RefCountHooks {
+    static void OnCreate(const void*, const std::type_info&, const void*, std::size_t) {
+    }
+
+    static void OnUpdate(const void*, RefKind, int) {
+    }
+
+    static void OnObjectDestroyed(const void*) {
+    }
+
+    static void OnDestroy(const void*) {
+    }
+
+    // Empty base of every SharedPtr<T, Policy>, Owner is that SharedPtr.
+    template <typename Owner>
+    struct PointerTracker {};
+};
+
+// Reference counting policies. Increments only need to be atomic, never ordered:
+// whoever copies a pointer already holds a reference, so the object cannot go away.
+// Decrements are acq_rel so that every write made through one owner happens before
+// the destructor run by the last one.
+struct AtomicRefCount : RefCountHooks {
+    using Counter = std::atomic<std::size_t>;
+
+    static void Increment(Counter& counter) noexcept {
+        counter.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Returns the value after the decrement.
+    static std::size_t Decrement(Counter& counter) noexcept {
+        return counter.fetch_sub(1, std::memory_order_acq_rel) - 1;
+    }
+
+    static std::size_t Load(const Counter& counter) noexcept {
+        return counter.load(std::memory_order_relaxed);
+    }
+
+    // Takes a reference unless the count already dropped to zero, which is how a weak
+    // observer upgrades without ever resurrecting an object that is being destroyed.
+    static bool IncrementIfNotZero(Counter& counter) noexcept {
+        std::size_t count = counter.load(std::memory_order_relaxed);
+        do {
+            if (count == 0) {
+                return false;
+            }
+        } while (!counter.compare_exchange_weak(count, count + 1, std::memory_order_acq_rel,
+                                                std::memory_order_relaxed));
+        return true;
+    }
+};
+
+// For objects that never leave their thread: plain integer arithmetic.
+struct NonAtomicRefCount : RefCountHooks {
+    using Counter = std::size_t;
+
+    static void Increment(Counter& counter) noexcept {
+        ++counter;
+    }
+
+    static std::size_t Decrement(Counter& counter) noexcept {
+        return --counter;
+    }
+
+    static std::size_t Load(const Counter& counter) noexcept {
+        return counter;
+    }
+
+    static bool IncrementIfNotZero(Counter& counter) noexcept {
+        if (counter == 0) {
+            return false;
+        }
+        ++counter;
+        return true;
+    }
+};
+
+// Counts exactly like Base, and additionally reports every block, count update and
+// SharedPtr to RefCountRegistry. Use it explicitly, e.g.
+// MakeSharedWithPolicy<T, InstrumentedRefCount<>>(...), or build with
+// SHARED_PTR_INSTRUMENTATION defined to make it the default for every SharedPtr.
+template <typename Base = AtomicRefCount>
+struct InstrumentedRefCount : Base {
+    static void OnCreate(const void* block, const std::type_info& type, const void* object,
+                         std::size_t size) {
+        RefCountRegistry::Instance().OnCreate(block, type, object, size);
+    }
+
+    static void OnUpdate(const void* block, RefKind kind, int delta) {
+        RefCountRegistry::Instance().OnUpdate(block, kind, delta);
+    }
+
+    static void OnObjectDestroyed(const void* block) {
+        RefCountRegistry::Instance().OnObjectDestroyed(block);
+    }
+
+    static void OnDestroy(const void* block) {
+        RefCountRegistry::Instance().OnDestroy(block);
+    }
+
+    // Registers the SharedPtr it is a base of, which is what lets the registry find
+    // references stored inside managed objects.
+    template <typename Owner>
+    struct PointerTracker {
+        PointerTracker() {
+            RefCountRegistry::Instance().TrackPointer(this, &GetControl);
+        }
+
+        PointerTracker(const PointerTracker&) : PointerTracker() {
+        }
+
+        PointerTracker& operator=(const PointerTracker&) noexcept {
+            return *this;
+        }
+
+        ~PointerTracker() {
+            RefCountRegistry::Instance().UntrackPointer(this);
+        }
+
+        static const void* GetControl(const void* tracker) {
+            return Owner::GetTrackedControl(
+                *static_cast<const Owner*>(static_cast<const PointerTracker*>(tracker)));
+        }
+    };
+};
+
+#ifdef SHARED_PTR_INSTRUMENTATION
+using DefaultRefCount = InstrumentedRefCount<AtomicRefCount>;
+#else
+using DefaultRefCount = AtomicRefCount;
+#endif
+
+template <typename Policy = DefaultRefCount>
 class SharedCount {
 public:
     explicit SharedCount(std::size_t count = 0) noexcept : StrongCount(count) {
     }
 
     void AddStrongPtr() {
-        StrongCount += 1;
+        Policy::Increment(StrongCount);
+    }
+
+    // Used by WeakPtr::Lock, fails once the object has been destroyed.
+    bool TryAddStrongPtr() {
+        return Policy::IncrementIfNotZero(StrongCount);
     }
 
     size_t GetStrongCount() {
-        return StrongCount;
+        return Policy::Load(StrongCount);
     }
 
 protected:
-    std::atomic<std::size_t> StrongCount = 0;
+    typename Policy::Counter StrongCount;
 };
 
-class SharedWeakCount : public SharedCount {
+// WeakCount includes one extra reference held on behalf of all strong owners
+// together, so each counter is only ever inspected through its own decrement.
+template <typename Policy = DefaultRefCount>
+class SharedWeakCount : public SharedCount<Policy> {
 public:
     void AddWeakPtr() {
-        WeakCount += 1;
+        Policy::Increment(WeakCount);
     }
 
     size_t GetWeakCount() {
-        return WeakCount;
+        return Policy::Load(WeakCount);
     }
 
 protected:
-    std::atomic<size_t> WeakCount = 0;
+    typename Policy::Counter WeakCount{1};
 };
 
-template <typename T, typename Deleter = std::default_delete<T>>
-class ControlBlock : public SharedWeakCount {
+// SharedPtr/WeakPtr only ever see this base, so the same SharedPtr<T> can point to
+// an object owned through a deleter or to one living inside the control block.
+// The object is destroyed as soon as the last strong owner goes away, outstanding
+// WeakPtrs only keep the (small) control block alive.
+template <typename Policy = DefaultRefCount>
+class ControlBlockBase : public SharedWeakCount<Policy> {
 public:
-    ControlBlock() {
-        ptr_ = new T();
+    virtual ~ControlBlockBase() = default;
+
+    void AddStrongPtr() {
+        SharedWeakCount<Policy>::AddStrongPtr();
+        Policy::OnUpdate(this, RefKind::kStrong, 1);
     }
-    ControlBlock(T* ptr, Deleter deleter) : ptr_(ptr), del_(deleter) {
+
+    bool TryAddStrongPtr() {
+        if (!SharedWeakCount<Policy>::TryAddStrongPtr()) {
+            return false;
+        }
+        Policy::OnUpdate(this, RefKind::kStrong, 1);
+        return true;
     }
 
-    explicit ControlBlock(T* ptr) : ptr_(ptr), del_(std::default_delete<T>()) {
+    void AddWeakPtr() {
+        SharedWeakCount<Policy>::AddWeakPtr();
+        Policy::OnUpdate(this, RefKind::kWeak, 1);
     }
 
     void DelShared() {
-        StrongCount -= 1;
-        if (NeedDel()) {
-            del_(ptr_);
+        Policy::OnUpdate(this, RefKind::kStrong, -1);
+        if (Policy::Decrement(this->StrongCount) == 0) {
+            Policy::OnObjectDestroyed(this);
+            DestroyObject();
+            ReleaseWeak();
         }
     }
 
     void DelWeak() {
-        WeakCount -= 1;
-        if (NeedDel()) {
-            del_(ptr_);
+        Policy::OnUpdate(this, RefKind::kWeak, -1);
+        ReleaseWeak();
+    }
+
+protected:
+    // Ends the lifetime of the managed object.
+    virtual void DestroyObject() noexcept = 0;
+
+    // Frees the control block itself, overridden by blocks that did not come from new.
+    virtual void DestroyBlock() noexcept {
+        delete this;
+    }
+
+private:
+    // Drops a weak reference without reporting it, the implicit one held by the strong
+    // owners is never reported as added either.
+    void ReleaseWeak() {
+        if (Policy::Decrement(this->WeakCount) == 0) {
+            Policy::OnDestroy(this);
+            DestroyBlock();
+        }
+    }
+};
+
+// Specialize as std::true_type for hot types so that SharedPtr<T>(new T) takes its
+// control block from ControlBlockPool instead of the global heap.
+template <typename T>
+struct PooledControlBlock : std::false_type {};
+
+// Process-wide free list of equally sized control blocks. Chunks are never returned
+// to the heap, the pool only grows to the peak number of live blocks.
+template <std::size_t Size, std::size_t Align>
+class ControlBlockPool {
+public:
+    static void* Allocate() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_list_ == nullptr) {
+            Grow();
         }
+        Slot* slot = free_list_;
+        free_list_ = slot->next;
+        return slot->storage;
+    }
+
+    static void Deallocate(void* p) noexcept {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Slot* slot = static_cast<Slot*>(p);
+        slot->next = free_list_;
+        free_list_ = slot;
     }
 
-    bool IsEmpty() {
-        return ptr_ == nullptr;
+    static std::size_t GetCapacity() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return capacity_;
+    }
+
+private:
+    union Slot {
+        Slot* next;
+        alignas(Align) unsigned char storage[Size];
+    };
+
+    static const std::size_t kSlotsPerChunk = 64;
+
+    struct Chunk {
+        Chunk* next;
+        Slot slots[kSlotsPerChunk];
+    };
+
+    static void Grow() {
+        chunks_ = new Chunk{chunks_, {}};
+        for (Slot& slot : chunks_->slots) {
+            slot.next = free_list_;
+            free_list_ = &slot;
+        }
+        capacity_ += kSlotsPerChunk;
+    }
+
+    static inline std::mutex mutex_;
+    static inline Slot* free_list_ = nullptr;
+    static inline Chunk* chunks_ = nullptr;
+    static inline std::size_t capacity_ = 0;
+};
+
+// Owns an object allocated elsewhere and releases it through Deleter.
+template <typename T, typename Deleter = std::default_delete<T>, typename Policy = DefaultRefCount>
+class ControlBlock : public ControlBlockBase<Policy> {
+public:
+    ControlBlock(T* ptr, Deleter deleter) : ptr_(ptr), del_(std::move(deleter)) {
+        Policy::OnCreate(this, typeid(T), ptr_, sizeof(T));
+    }
+
+    explicit ControlBlock(T* ptr) : ptr_(ptr), del_(std::default_delete<T>()) {
+        Policy::OnCreate(this, typeid(T), ptr_, sizeof(T));
     }
 
     T* GetPtr() {
         return ptr_;
     }
 
-    void SetPtr(T ptr) {
-        if (&ptr) {
-            ptr_ = &ptr;
+    static void* operator new(std::size_t size) {
+        if constexpr (PooledControlBlock<T>::value) {
+            return ControlBlockPool<sizeof(ControlBlock), alignof(ControlBlock)>::Allocate();
+        } else {
+            return ::operator new(size);
         }
     }
 
-    void SetPtr(T* ptr) {
-        ptr_ = ptr;
+    static void operator delete(void* p) noexcept {
+        if constexpr (PooledControlBlock<T>::value) {
+            ControlBlockPool<sizeof(ControlBlock), alignof(ControlBlock)>::Deallocate(p);
+        } else {
+            ::operator delete(p);
+        }
     }
 
-    void SetValues(size_t strong, size_t weak) {
-        WeakCount = weak;
-        StrongCount = strong;
+protected:
+    void DestroyObject() noexcept override {
+        if (ptr_ != nullptr) {
+            del_(ptr_);
+        }
     }
 
 private:
     T* ptr_ = nullptr;
     Deleter del_;
-    bool NeedDel() {
-        return GetStrongCount() + GetWeakCount() == 0 && ptr_ != nullptr;
+};
+
+// Stores the object right after the counters, so MakeShared needs one allocation
+// and dereferencing touches the same cache line as the reference counts. The price is
+// that the object's storage is only released together with the block, after the last
+// WeakPtr, even though its destructor runs as soon as the last SharedPtr is gone.
+template <typename T, typename Policy = DefaultRefCount>
+class InplaceControlBlock : public ControlBlockBase<Policy> {
+public:
+    template <typename... Args>
+    explicit InplaceControlBlock(Args&&... args) {
+        ::new (static_cast<void*>(&storage_)) T(std::forward<Args>(args)...);
+        Policy::OnCreate(this, typeid(T), &storage_, sizeof(T));
+    }
+
+    T* GetPtr() {
+        return std::launder(reinterpret_cast<T*>(&storage_));
+    }
+
+protected:
+    void DestroyObject() noexcept override {
+        GetPtr()->~T();
     }
-};
\ No newline at end of file
+
+private:
+    std::aligned_storage_t<sizeof(T), alignof(T)> storage_;
+};
+
+// Same layout as InplaceControlBlock, but both the block and the object are obtained
+// from and returned to a user allocator, which the block keeps a rebound copy of.
+template <typename T, typename Allocator, typename Policy = DefaultRefCount>
+class AllocatedControlBlock : public ControlBlockBase<Policy> {
+public:
+    using BlockAllocator =
+        typename std::allocator_traits<Allocator>::template rebind_alloc<AllocatedControlBlock>;
+    using BlockTraits = std::allocator_traits<BlockAllocator>;
+
+    template <typename... Args>
+    explicit AllocatedControlBlock(const Allocator& alloc, Args&&... args) : alloc_(alloc) {
+        ValueAllocator value_alloc(alloc_);
+        ValueTraits::construct(value_alloc, GetPtr(), std::forward<Args>(args)...);
+        Policy::OnCreate(this, typeid(T), &storage_, sizeof(T));
+    }
+
+    T* GetPtr() {
+        return std::launder(reinterpret_cast<T*>(&storage_));
+    }
+
+protected:
+    void DestroyObject() noexcept override {
+        ValueAllocator value_alloc(alloc_);
+        ValueTraits::destroy(value_alloc, GetPtr());
+    }
+
+    void DestroyBlock() noexcept override {
+        BlockAllocator alloc(alloc_);
+        this->~AllocatedControlBlock();
+        BlockTraits::deallocate(alloc, this, 1);
+    }
+
+private:
+    using ValueAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+    using ValueTraits = std::allocator_traits<ValueAllocator>;
+
+    BlockAllocator alloc_;
+    std::aligned_storage_t<sizeof(T), alignof(T)> storage_;
+};
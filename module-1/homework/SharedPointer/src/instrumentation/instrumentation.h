@@ -0,0 +1,277 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __GNUG__
+#include <cxxabi.h>
+#endif
+
+enum class RefKind { kStrong, kWeak };
+
+// Debug-only bookkeeping behind InstrumentedRefCount: every control block, every
+// reference count update and every live SharedPtr goes through one mutex, so this is
+// meant for test and profiling builds, never for production traffic.
+class RefCountRegistry {
+public:
+    // Maps a tracked SharedPtr to the control block it currently points to.
+    using ControlGetter = const void* (*)(const void* pointer);
+
+    struct TypeStats {
+        std::size_t created = 0;
+        std::size_t destroyed = 0;
+        std::size_t strong_increments = 0;
+        std::size_t strong_decrements = 0;
+        std::size_t weak_increments = 0;
+        std::size_t weak_decrements = 0;
+        // Updates made by a different thread than the previous update of the same block,
+        // each one is a cache line moving between cores.
+        std::size_t handoffs = 0;
+        std::chrono::nanoseconds total_lifetime{0};
+        std::chrono::nanoseconds max_lifetime{0};
+    };
+
+    // Never destroyed, pointers in other static objects may still untrack at exit.
+    static RefCountRegistry& Instance() {
+        static RefCountRegistry* registry = new RefCountRegistry();
+        return *registry;
+    }
+
+    void OnCreate(const void* block, const std::type_info& type, const void* object,
+                  std::size_t size) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Block& info = blocks_[block];
+        info.type = Demangle(type.name());
+        info.object = static_cast<const char*>(object);
+        info.size = size;
+        info.created = std::chrono::steady_clock::now();
+        ++stats_[info.type].created;
+    }
+
+    void OnUpdate(const void* block, RefKind kind, int delta) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = blocks_.find(block);
+        if (it == blocks_.end()) {
+            return;
+        }
+        TypeStats& stats = stats_[it->second.type];
+        if (kind == RefKind::kStrong) {
+            ++(delta > 0 ? stats.strong_increments : stats.strong_decrements);
+        } else {
+            ++(delta > 0 ? stats.weak_increments : stats.weak_decrements);
+        }
+        std::thread::id thread = std::this_thread::get_id();
+        if (it->second.last_thread != std::thread::id() && it->second.last_thread != thread) {
+            ++stats.handoffs;
+        }
+        it->second.last_thread = thread;
+    }
+
+    // The managed object is gone, pointers stored inside it no longer own anything.
+    void OnObjectDestroyed(const void* block) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = blocks_.find(block);
+        if (it != blocks_.end()) {
+            it->second.object = nullptr;
+        }
+    }
+
+    void OnDestroy(const void* block) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = blocks_.find(block);
+        if (it == blocks_.end()) {
+            return;
+        }
+        TypeStats& stats = stats_[it->second.type];
+        auto lifetime = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - it->second.created);
+        ++stats.destroyed;
+        stats.total_lifetime += lifetime;
+        stats.max_lifetime = std::max(stats.max_lifetime, lifetime);
+        blocks_.erase(it);
+    }
+
+    void TrackPointer(const void* pointer, ControlGetter getter) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pointers_[pointer] = getter;
+    }
+
+    void UntrackPointer(const void* pointer) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pointers_.erase(pointer);
+    }
+
+    std::map<std::string, TypeStats> GetStats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+    std::size_t GetLiveBlocks() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return blocks_.size();
+    }
+
+    // Forgets the counters, blocks and pointers that are alive stay tracked.
+    void ResetStats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.clear();
+    }
+
+    // Groups of live control blocks that keep each other alive through SharedPtrs
+    // stored directly inside their objects, each as the sorted type names of its
+    // members. Pointers held indirectly (e.g. in a std::vector member) are not seen.
+    // The pointers are read without synchronization, call this while they are quiet.
+    std::vector<std::vector<std::string>> FindCycles() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        std::map<const char*, const void*> objects;
+        for (const auto& [block, info] : blocks_) {
+            if (info.object != nullptr) {
+                objects[info.object] = block;
+            }
+        }
+        std::unordered_map<const void*, std::vector<const void*>> edges;
+        for (const auto& [pointer, getter] : pointers_) {
+            const void* owner = FindOwner(objects, static_cast<const char*>(pointer));
+            const void* target = getter(pointer);
+            if (owner != nullptr && target != nullptr && blocks_.count(target)) {
+                edges[owner].push_back(target);
+            }
+        }
+
+        std::vector<std::vector<std::string>> cycles;
+        for (const auto& component : StronglyConnected(edges)) {
+            const void* first = component.front();
+            auto self = std::find(edges[first].begin(), edges[first].end(), first);
+            if (component.size() == 1 && self == edges[first].end()) {
+                continue;
+            }
+            std::vector<std::string> types;
+            for (const void* block : component) {
+                types.push_back(blocks_.at(block).type);
+            }
+            std::sort(types.begin(), types.end());
+            cycles.push_back(std::move(types));
+        }
+        std::sort(cycles.begin(), cycles.end());
+        return cycles;
+    }
+
+    // One line per type sorted by name followed by the cycles, meant to be diffed
+    // between releases. Lifetimes are left out on purpose, they differ run to run.
+    std::string Report() const {
+        std::ostringstream out;
+        for (const auto& [type, stats] : GetStats()) {
+            out << type << ": created=" << stats.created << " destroyed=" << stats.destroyed
+                << " strong=+" << stats.strong_increments << "/-" << stats.strong_decrements
+                << " weak=+" << stats.weak_increments << "/-" << stats.weak_decrements
+                << " handoffs=" << stats.handoffs << "\n";
+        }
+        for (const auto& cycle : FindCycles()) {
+            out << "cycle:";
+            for (std::size_t i = 0; i < cycle.size(); ++i) {
+                out << (i == 0 ? " " : ", ") << cycle[i];
+            }
+            out << "\n";
+        }
+        return out.str();
+    }
+
+private:
+    struct Block {
+        std::string type;
+        const char* object = nullptr;
+        std::size_t size = 0;
+        std::chrono::steady_clock::time_point created;
+        std::thread::id last_thread;
+    };
+
+    RefCountRegistry() = default;
+
+    static std::string Demangle(const char* name) {
+#ifdef __GNUG__
+        int status = 0;
+        char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+        if (status == 0) {
+            std::string result = demangled;
+            std::free(demangled);
+            return result;
+        }
+#endif
+        return name;
+    }
+
+    const void* FindOwner(const std::map<const char*, const void*>& objects,
+                          const char* address) const {
+        auto it = objects.upper_bound(address);
+        if (it == objects.begin()) {
+            return nullptr;
+        }
+        --it;
+        const Block& info = blocks_.at(it->second);
+        return address < info.object + info.size ? it->second : nullptr;
+    }
+
+    // Tarjan's algorithm.
+    static std::vector<std::vector<const void*>> StronglyConnected(
+        const std::unordered_map<const void*, std::vector<const void*>>& edges) {
+        std::unordered_map<const void*, std::size_t> index;
+        std::unordered_map<const void*, std::size_t> low;
+        std::vector<const void*> stack;
+        std::unordered_map<const void*, bool> on_stack;
+        std::vector<std::vector<const void*>> components;
+
+        std::function<void(const void*)> visit = [&](const void* node) {
+            std::size_t order = index.size();
+            index[node] = order;
+            low[node] = order;
+            stack.push_back(node);
+            on_stack[node] = true;
+            auto it = edges.find(node);
+            if (it != edges.end()) {
+                for (const void* next : it->second) {
+                    if (!index.count(next)) {
+                        visit(next);
+                        low[node] = std::min(low[node], low[next]);
+                    } else if (on_stack[next]) {
+                        low[node] = std::min(low[node], index[next]);
+                    }
+                }
+            }
+            if (low[node] == index[node]) {
+                std::vector<const void*> component;
+                const void* member = nullptr;
+                do {
+                    member = stack.back();
+                    stack.pop_back();
+                    on_stack[member] = false;
+                    component.push_back(member);
+                } while (member != node);
+                components.push_back(std::move(component));
+            }
+        };
+        for (const auto& [node, targets] : edges) {
+            if (!index.count(node)) {
+                visit(node);
+            }
+        }
+        return components;
+    }
+
+    mutable std::mutex mutex_;
+    std::unordered_map<const void*, Block> blocks_;
+    std::unordered_map<const void*, ControlGetter> pointers_;
+    std::map<std::string, TypeStats> stats_;
+};
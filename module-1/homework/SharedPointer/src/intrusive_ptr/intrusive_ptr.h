@@ -0,0 +1,183 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "../control/control.h"
+
+// CRTP base embedding the reference count in the object itself, so IntrusivePtr is a
+// single pointer and dereferencing it never goes through a control block:
+//
+//     class Node : public RefCounted<Node> { ... };
+//     IntrusivePtr<Node> node = MakeIntrusive<Node>(...);
+//
+// There is no weak count, objects are deleted as soon as the last IntrusivePtr goes.
+// The delete goes through T*, so hierarchies handed out as IntrusivePtr<Base> need a
+// virtual destructor in T.
+template <typename T, typename Policy = AtomicRefCount>
+class RefCounted {
+public:
+    void AddRef() const noexcept {
+        Policy::Increment(ref_count_);
+    }
+
+    void DelRef() const noexcept {
+        if (Policy::Decrement(ref_count_) == 0) {
+            delete static_cast<const T*>(this);
+        }
+    }
+
+    std::size_t GetRefCount() const noexcept {
+        return Policy::Load(ref_count_);
+    }
+
+protected:
+    RefCounted() = default;
+
+    // Copies of an object start with their own count.
+    RefCounted(const RefCounted&) noexcept {
+    }
+
+    RefCounted& operator=(const RefCounted&) noexcept {
+        return *this;
+    }
+
+    ~RefCounted() = default;
+
+private:
+    mutable typename Policy::Counter ref_count_{0};
+};
+
+template <typename T>
+class IntrusivePtr {
+public:
+    constexpr IntrusivePtr() noexcept = default;
+    ~IntrusivePtr();
+
+    // Unlike SharedPtr, taking a raw pointer that is already owned elsewhere is safe:
+    // the count travels with the object.
+    explicit IntrusivePtr(T* p) noexcept;
+
+    IntrusivePtr(const IntrusivePtr& other) noexcept;
+    IntrusivePtr(IntrusivePtr&& other) noexcept;
+
+    template <typename Y>
+    IntrusivePtr(const IntrusivePtr<Y>& other) noexcept;  // NOLINT
+
+    template <typename Y>
+    IntrusivePtr(IntrusivePtr<Y>&& other) noexcept;  // NOLINT
+
+    IntrusivePtr& operator=(const IntrusivePtr& r) noexcept;
+    IntrusivePtr& operator=(IntrusivePtr&& r) noexcept;
+
+    // Modifiers
+    void Reset() noexcept;
+    void Reset(T* p) noexcept;
+    void Swap(IntrusivePtr& other) noexcept;
+
+    // Observers
+    T* Get() const noexcept;
+    int64_t UseCount() const noexcept;
+    T& operator*() const noexcept;
+    T* operator->() const noexcept;
+    explicit operator bool() const noexcept {
+        return ptr_ != nullptr;
+    };
+
+    template <typename U>
+    friend class IntrusivePtr;
+
+private:
+    T* ptr_ = nullptr;
+};
+
+// MakeIntrusive
+template <typename T, typename... Args>
+IntrusivePtr<T> MakeIntrusive(Args&&... args) {
+    return IntrusivePtr<T>(new T(std::forward<Args>(args)...));
+}
+// MakeIntrusive
+
+// IntrusivePtr
+template <typename T>
+IntrusivePtr<T>::IntrusivePtr(T* p) noexcept : ptr_(p) {
+    if (ptr_) {
+        ptr_->AddRef();
+    }
+}
+
+template <typename T>
+IntrusivePtr<T>::~IntrusivePtr() {
+    if (ptr_) {
+        ptr_->DelRef();
+    }
+}
+
+template <typename T>
+IntrusivePtr<T>::IntrusivePtr(const IntrusivePtr& other) noexcept : IntrusivePtr(other.ptr_) {
+}
+
+template <typename T>
+IntrusivePtr<T>::IntrusivePtr(IntrusivePtr&& other) noexcept : ptr_(other.ptr_) {
+    other.ptr_ = nullptr;
+}
+
+template <typename T>
+template <typename Y>
+IntrusivePtr<T>::IntrusivePtr(const IntrusivePtr<Y>& other) noexcept : IntrusivePtr(other.ptr_) {
+}
+
+template <typename T>
+template <typename Y>
+IntrusivePtr<T>::IntrusivePtr(IntrusivePtr<Y>&& other) noexcept : ptr_(other.ptr_) {
+    other.ptr_ = nullptr;
+}
+
+template <typename T>
+IntrusivePtr<T>& IntrusivePtr<T>::operator=(const IntrusivePtr& r) noexcept {
+    IntrusivePtr<T>(r).Swap(*this);
+    return *this;
+}
+
+template <typename T>
+IntrusivePtr<T>& IntrusivePtr<T>::operator=(IntrusivePtr&& r) noexcept {
+    IntrusivePtr<T>(std::move(r)).Swap(*this);
+    return *this;
+}
+
+template <typename T>
+void IntrusivePtr<T>::Reset() noexcept {
+    IntrusivePtr<T>().Swap(*this);
+}
+
+template <typename T>
+void IntrusivePtr<T>::Reset(T* p) noexcept {
+    IntrusivePtr<T>(p).Swap(*this);
+}
+
+template <typename T>
+void IntrusivePtr<T>::Swap(IntrusivePtr& other) noexcept {
+    std::swap(ptr_, other.ptr_);
+}
+
+template <typename T>
+T* IntrusivePtr<T>::Get() const noexcept {
+    return ptr_;
+}
+
+template <typename T>
+int64_t IntrusivePtr<T>::UseCount() const noexcept {
+    return ptr_ ? static_cast<int64_t>(ptr_->GetRefCount()) : 0;
+}
+
+template <typename T>
+T& IntrusivePtr<T>::operator*() const noexcept {
+    return *ptr_;
+}
+
+template <typename T>
+T* IntrusivePtr<T>::operator->() const noexcept {
+    return ptr_;
+}
+// IntrusivePtr
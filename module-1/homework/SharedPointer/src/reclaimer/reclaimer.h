@@ -0,0 +1,164 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../shared_ptr/shared_ptr.h"
+
+struct ReclaimerOptions {
+    // Retired objects allowed to wait at once. When the queue is full Retire destroys
+    // the object on the calling thread, so a stalled worker cannot grow memory unbounded.
+    std::size_t capacity = std::size_t{1} << 16;
+    // How often the worker closes an epoch and destroys what was retired during it.
+    std::chrono::milliseconds epoch{10};
+    // Without a worker nothing is reclaimed until someone calls Collect(), which lets
+    // the application pick the thread (and the moment) that pays for destruction.
+    bool start_worker = true;
+};
+
+// Moves destruction of objects whose last owner went away off the releasing thread.
+// Retire only appends to the current epoch's batch. At the end of each epoch the
+// batch is swapped out and destroyed as a whole by the worker, outside the lock.
+class Reclaimer {
+public:
+    explicit Reclaimer(const ReclaimerOptions& options = ReclaimerOptions()) : options_(options) {
+        retired_.reserve(options_.capacity);
+        collected_.reserve(options_.capacity);
+        if (options_.start_worker) {
+            worker_ = std::thread([this] { Run(); });
+        }
+    }
+
+    Reclaimer(const Reclaimer&) = delete;
+    Reclaimer& operator=(const Reclaimer&) = delete;
+
+    // Stops the worker and destroys everything still queued.
+    ~Reclaimer() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wakeup_.notify_one();
+        if (worker_.joinable()) {
+            worker_.join();
+        }
+        // Destructors may retire further objects.
+        while (Collect() != 0) {
+        }
+    }
+
+    // Shared by DeferredDelete instances that were not given a reclaimer.
+    static Reclaimer& Default() {
+        static Reclaimer reclaimer;
+        return reclaimer;
+    }
+
+    template <typename T>
+    void Retire(T* p) {
+        Retire(static_cast<void*>(p), [](void* q) { delete static_cast<T*>(q); });
+    }
+
+    void Retire(void* p, void (*destroy)(void*)) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (retired_.size() < options_.capacity) {
+                retired_.push_back({p, destroy});
+                return;
+            }
+        }
+        inline_reclaims_.fetch_add(1, std::memory_order_relaxed);
+        wakeup_.notify_one();
+        destroy(p);
+    }
+
+    // Closes the current epoch and destroys everything retired in it on the calling
+    // thread. Returns the number of objects destroyed.
+    std::size_t Collect() {
+        std::lock_guard<std::mutex> collect_lock(collect_mutex_);
+        {
+            // The two batches trade places, so neither ever reallocates.
+            std::lock_guard<std::mutex> lock(mutex_);
+            collected_.swap(retired_);
+            epoch_.fetch_add(1, std::memory_order_relaxed);
+        }
+        for (const Retired& retired : collected_) {
+            retired.destroy(retired.p);
+        }
+        std::size_t count = collected_.size();
+        collected_.clear();
+        return count;
+    }
+
+    std::size_t GetPending() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return retired_.size();
+    }
+
+    std::size_t GetInlineReclaims() const {
+        return inline_reclaims_.load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t GetEpoch() const {
+        return epoch_.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Retired {
+        void* p;
+        void (*destroy)(void*);
+    };
+
+    void Run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stopping_) {
+            wakeup_.wait_for(lock, options_.epoch);
+            lock.unlock();
+            Collect();
+            lock.lock();
+        }
+    }
+
+    ReclaimerOptions options_;
+    mutable std::mutex mutex_;
+    std::condition_variable wakeup_;
+    std::vector<Retired> retired_;
+    std::mutex collect_mutex_;
+    std::vector<Retired> collected_;
+    bool stopping_ = false;
+    std::atomic<std::size_t> inline_reclaims_{0};
+    std::atomic<std::uint64_t> epoch_{0};
+    std::thread worker_;
+};
+
+// Deleter handing the object to a Reclaimer instead of deleting it in place:
+//
+//     SharedPtr<Graph> graph(new Graph, DeferredDelete<Graph>(reclaimer));
+template <typename T>
+struct DeferredDelete {
+    DeferredDelete() noexcept : reclaimer(&Reclaimer::Default()) {
+    }
+
+    explicit DeferredDelete(Reclaimer& reclaimer) noexcept : reclaimer(&reclaimer) {
+    }
+
+    void operator()(T* p) const {
+        reclaimer->Retire(p);
+    }
+
+    Reclaimer* reclaimer;
+};
+
+// MakeShared counterpart for objects destroyed through the default reclaimer. The
+// object is allocated separately from the control block, so its memory goes back
+// together with its destructor on the reclaimer's thread.
+template <typename T, typename... Args>
+SharedPtr<T> MakeSharedDeferred(Args&&... args) {
+    return SharedPtr<T>(new T(std::forward<Args>(args)...), DeferredDelete<T>());
+}
@@ -1,20 +1,29 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
 #include "../control/control.h"
+#include "../unique_ptr/unique_ptr.h"
 
 // SharedPtr
-template <typename T>
+template <typename T, typename Policy = DefaultRefCount>
 class WeakPtr;
 
 template <typename T>
-class SharedPtr {
+class AtomicSharedPtr;
+
+template <typename T, typename Policy = DefaultRefCount>
+class EnableSharedFromThis;
+
+template <typename T, typename Policy = DefaultRefCount>
+class SharedPtr : public Policy::template PointerTracker<SharedPtr<T, Policy>> {
 public:
     constexpr SharedPtr() noexcept = default;
     ~SharedPtr();
     template <typename Y>
-    explicit SharedPtr(Y* p) : control_(new ControlBlock<T>(p)) {
-        control_->AddStrongPtr();
-    };
+    explicit SharedPtr(Y* p);
 
     template <typename Y, typename Deleter>
     SharedPtr(Y* p, Deleter deleter) noexcept;
@@ -22,17 +31,38 @@ public:
     SharedPtr(const SharedPtr& other) noexcept;
     SharedPtr(SharedPtr&& other) noexcept;
 
+    template <typename Y>
+    SharedPtr(const SharedPtr<Y, Policy>& other) noexcept;  // NOLINT
+
+    template <typename Y>
+    SharedPtr(SharedPtr<Y, Policy>&& other) noexcept;  // NOLINT
+
+    // Aliasing: shares ownership with other but points to ptr, typically a member or a
+    // slice of the object other owns. No new control block is created.
+    template <typename Y>
+    SharedPtr(const SharedPtr<Y, Policy>& other, T* ptr) noexcept;
+
+    template <typename Y>
+    SharedPtr(SharedPtr<Y, Policy>&& other, T* ptr) noexcept;
+
     SharedPtr& operator=(const SharedPtr& r) noexcept;
 
     template <typename Y>
-    SharedPtr& operator=(const SharedPtr<Y>& r) noexcept;
+    SharedPtr& operator=(const SharedPtr<Y, Policy>& r) noexcept;
 
     SharedPtr& operator=(SharedPtr&& r) noexcept;
 
     template <typename Y>
-    SharedPtr& operator=(SharedPtr<Y>&& r) noexcept;
+    SharedPtr& operator=(SharedPtr<Y, Policy>&& r) noexcept;
 
-    explicit SharedPtr(const WeakPtr<T>& other) noexcept;
+    explicit SharedPtr(const WeakPtr<T, Policy>& other) noexcept;
+
+    // Takes over the object and the deleter, the object itself is not reallocated.
+    template <typename Y, typename Deleter>
+    SharedPtr(UniquePtr<Y, Deleter>&& other);  // NOLINT
+
+    template <typename Y, typename Deleter>
+    SharedPtr& operator=(UniquePtr<Y, Deleter>&& r);
 
     // Modifiers
     void Reset() noexcept;
@@ -52,280 +82,447 @@ public:
     T* operator->() const noexcept;
     T& operator[](std::ptrdiff_t idx) const;
     explicit operator bool() const noexcept {
-        return control_ && !control_->IsEmpty();
+        return ptr_ != nullptr;
     };
 
-    template <typename U>
-    friend class WeakPtr;
-
-private:
-    ControlBlock<T>* control_ = nullptr;
-};
+    template <typename U, typename P>
+    friend class SharedPtr;
 
-template <typename T, typename... Args>
-SharedPtr<T> MakeShared(Args&&... args) {
-    return SharedPtr<T>(new T(std::forward<Args>(args)...));
-}
+    template <typename U, typename P>
+    friend class WeakPtr;
 
-template <typename T>
-SharedPtr<T>::~SharedPtr() {
-    if (control_) {
-        control_->DelShared();
-    }
-}
+    template <typename U>
+    friend class AtomicSharedPtr;
 
-// MakeShared
-// Your code goes here...
-// MakeShared
+    template <typename U, typename P, typename... Args>
+    friend SharedPtr<U, P> MakeSharedWithPolicy(Args&&... args);
 
-// SharedPtr
-// Your code goes here...
-// SharedPtr
+    template <typename U, typename Allocator, typename... Args>
+    friend SharedPtr<U> AllocateShared(const Allocator& alloc, Args&&... args);
 
-// WeakPtr
-template <typename T>
-class WeakPtr {
+private:
+    struct AdoptTag {};
 
-public:
-    // Special-member functions
-    constexpr WeakPtr() noexcept = default;
-    template <typename Y>
-    explicit WeakPtr(const SharedPtr<Y>& other);
-    WeakPtr(const WeakPtr& other) noexcept;
-    WeakPtr(WeakPtr&& other) noexcept;
-    template <typename Y>
-    WeakPtr& operator=(const SharedPtr<Y>& other);
-    WeakPtr& operator=(const WeakPtr& other) noexcept;
-    WeakPtr& operator=(WeakPtr&& other) noexcept;
+    friend typename Policy::template PointerTracker<SharedPtr>;
 
-    ~WeakPtr();
+    static const void* GetTrackedControl(const SharedPtr& p) noexcept {
+        return p.control_;
+    }
 
-    // Modifiers
-    void Reset() noexcept;
-    void Swap(WeakPtr<T>& other) noexcept;
-
-    // Observers
-    bool Expired() const noexcept;
-    SharedPtr<T> Lock() const noexcept;
+    // Takes ownership of a freshly created control block managing ptr.
+    SharedPtr(AdoptTag, T* ptr, ControlBlockBase<Policy>* control) noexcept;
 
+    // Points the object's EnableSharedFromThis base, if it has one, at this owner.
     template <typename U>
-    friend class SharedPtr;
+    void HookSharedFromThis(const EnableSharedFromThis<U, Policy>* base) noexcept;
 
-public:
-    ControlBlock<T>* control_;
+    void HookSharedFromThis(...) noexcept {
+    }
+
+    T* ptr_ = nullptr;
+    ControlBlockBase<Policy>* control_ = nullptr;
 };
 
-template <typename T>
-T& SharedPtr<T>::operator*() const noexcept {
-    return *(control_->GetPtr());
+// MakeShared
+template <typename T, typename Policy, typename... Args>
+SharedPtr<T, Policy> MakeSharedWithPolicy(Args&&... args) {
+    auto control = new InplaceControlBlock<T, Policy>(std::forward<Args>(args)...);
+    return SharedPtr<T, Policy>(typename SharedPtr<T, Policy>::AdoptTag(), control->GetPtr(),
+                                control);
 }
 
-template <typename T>
-T* SharedPtr<T>::operator->() const noexcept {
-    return control_->GetPtr();
+template <typename T, typename... Args>
+SharedPtr<T> MakeShared(Args&&... args) {
+    return MakeSharedWithPolicy<T, DefaultRefCount>(std::forward<Args>(args)...);
 }
 
-template <typename T>
-int64_t SharedPtr<T>::UseCount() const noexcept {
-    return control_->GetStrongCount();
+// For objects that are never shared across threads: refcounts are plain integers.
+template <typename T, typename... Args>
+SharedPtr<T, NonAtomicRefCount> MakeLocalShared(Args&&... args) {
+    return MakeSharedWithPolicy<T, NonAtomicRefCount>(std::forward<Args>(args)...);
 }
 
-template <typename T>
-void SharedPtr<T>::Reset() noexcept {
-    control_ = nullptr;
+// Like MakeShared, but the fused control block is allocated through alloc
+// (rebound to the block type) and returned to it when the last reference goes away.
+template <typename T, typename Allocator, typename... Args>
+SharedPtr<T> AllocateShared(const Allocator& alloc, Args&&... args) {
+    using Block = AllocatedControlBlock<T, Allocator>;
+    typename Block::BlockAllocator block_alloc(alloc);
+    Block* control = Block::BlockTraits::allocate(block_alloc, 1);
+    try {
+        ::new (static_cast<void*>(control)) Block(alloc, std::forward<Args>(args)...);
+    } catch (...) {
+        Block::BlockTraits::deallocate(block_alloc, control, 1);
+        throw;
+    }
+    return SharedPtr<T>(typename SharedPtr<T>::AdoptTag(), control->GetPtr(), control);
 }
+// MakeShared
 
-template <typename T>
-template <typename Y, typename Deleter>
-SharedPtr<T>::SharedPtr(Y* p, Deleter deleter) noexcept
-    : control_(new ControlBlock<T, Deleter>(p, deleter)) {
+// SharedPtr
+template <typename T, typename Policy>
+SharedPtr<T, Policy>::SharedPtr(AdoptTag, T* ptr, ControlBlockBase<Policy>* control) noexcept
+    : ptr_(ptr), control_(control) {
     control_->AddStrongPtr();
+    HookSharedFromThis(ptr);
 }
 
-template <typename T>
-SharedPtr<T>::SharedPtr(const SharedPtr& other) noexcept {
-    control_ = other.control_;
+template <typename T, typename Policy>
+template <typename Y>
+SharedPtr<T, Policy>::SharedPtr(Y* p)
+    : ptr_(p), control_(new ControlBlock<Y, std::default_delete<Y>, Policy>(p)) {
     control_->AddStrongPtr();
+    HookSharedFromThis(p);
 }
 
-template <typename T>
-SharedPtr<T>& SharedPtr<T>::operator=(const SharedPtr& r) noexcept {
-    if (&r == this) {
-        return *this;
-    }
+template <typename T, typename Policy>
+template <typename Y, typename Deleter>
+SharedPtr<T, Policy>::SharedPtr(Y* p, Deleter deleter) noexcept
+    : ptr_(p), control_(new ControlBlock<Y, Deleter, Policy>(p, std::move(deleter))) {
+    control_->AddStrongPtr();
+    HookSharedFromThis(p);
+}
 
+template <typename T, typename Policy>
+SharedPtr<T, Policy>::~SharedPtr() {
     if (control_) {
         control_->DelShared();
     }
+}
 
-    control_ = r.control_;
-    control_->AddStrongPtr();
-    return *this;
+template <typename T, typename Policy>
+SharedPtr<T, Policy>::SharedPtr(const SharedPtr& other) noexcept
+    : ptr_(other.ptr_), control_(other.control_) {
+    if (control_) {
+        control_->AddStrongPtr();
+    }
 }
 
-template <typename T>
-SharedPtr<T>& SharedPtr<T>::operator=(SharedPtr<T>&& r) noexcept {
-    if (&r == this) {
-        return *this;
+template <typename T, typename Policy>
+SharedPtr<T, Policy>::SharedPtr(SharedPtr&& other) noexcept
+    : ptr_(other.ptr_), control_(other.control_) {
+    other.ptr_ = nullptr;
+    other.control_ = nullptr;
+}
+
+template <typename T, typename Policy>
+template <typename Y>
+SharedPtr<T, Policy>::SharedPtr(const SharedPtr<Y, Policy>& other) noexcept
+    : ptr_(other.ptr_), control_(other.control_) {
+    if (control_) {
+        control_->AddStrongPtr();
     }
+}
 
+template <typename T, typename Policy>
+template <typename Y>
+SharedPtr<T, Policy>::SharedPtr(SharedPtr<Y, Policy>&& other) noexcept
+    : ptr_(other.ptr_), control_(other.control_) {
+    other.ptr_ = nullptr;
+    other.control_ = nullptr;
+}
+
+template <typename T, typename Policy>
+template <typename Y>
+SharedPtr<T, Policy>::SharedPtr(const SharedPtr<Y, Policy>& other, T* ptr) noexcept
+    : ptr_(ptr), control_(other.control_) {
     if (control_) {
-        control_->DelShared();
+        control_->AddStrongPtr();
     }
+}
 
-    control_ = new ControlBlock<T>();
-    control_->SetPtr(r.control_->GetPtr());
-    control_->SetValues(r.control_->GetStrongCount(), r.control_->GetWeakCount());
-    r.control_->SetValues(0, 0);
-    r.control_->SetPtr(nullptr);
-    return *this;
+template <typename T, typename Policy>
+template <typename Y>
+SharedPtr<T, Policy>::SharedPtr(SharedPtr<Y, Policy>&& other, T* ptr) noexcept
+    : ptr_(ptr), control_(other.control_) {
+    other.ptr_ = nullptr;
+    other.control_ = nullptr;
 }
 
-template <typename T>
-SharedPtr<T>::SharedPtr(SharedPtr&& other) noexcept {
-    control_ = new ControlBlock<T>();
-    control_->SetValues(other.control_->GetStrongCount(), other.control_->GetWeakCount());
-    control_->SetPtr(other.control_->GetPtr());
-    other.control_->SetPtr(nullptr);
-    other.control_->SetValues(0, 0);
+template <typename T, typename Policy>
+template <typename U>
+void SharedPtr<T, Policy>::HookSharedFromThis(
+    const EnableSharedFromThis<U, Policy>* base) noexcept {
+    // An object handed to a second, independent SharedPtr keeps its first owner.
+    if (base != nullptr && base->weak_this_.Expired()) {
+        base->weak_this_ = SharedPtr<U, Policy>(*this, const_cast<U*>(static_cast<const U*>(base)));
+    }
 }
 
-template <typename T>
-void SharedPtr<T>::Swap(SharedPtr& other) noexcept {
-    swap(control_, other.control_);
+template <typename T, typename Policy>
+SharedPtr<T, Policy>& SharedPtr<T, Policy>::operator=(const SharedPtr& r) noexcept {
+    SharedPtr<T, Policy>(r).Swap(*this);
+    return *this;
 }
 
-template <typename T>
-T* SharedPtr<T>::Get() const noexcept {
-    return control_->GetPtr();
+template <typename T, typename Policy>
+template <typename Y>
+SharedPtr<T, Policy>& SharedPtr<T, Policy>::operator=(const SharedPtr<Y, Policy>& r) noexcept {
+    SharedPtr<T, Policy>(r).Swap(*this);
+    return *this;
 }
 
-template <typename T>
+template <typename T, typename Policy>
+SharedPtr<T, Policy>& SharedPtr<T, Policy>::operator=(SharedPtr<T, Policy>&& r) noexcept {
+    SharedPtr<T, Policy>(std::move(r)).Swap(*this);
+    return *this;
+}
+
+template <typename T, typename Policy>
 template <typename Y>
-void SharedPtr<T>::Reset(Y* p) noexcept {
-    SharedPtr<T>(p).Swap(*this);
+SharedPtr<T, Policy>& SharedPtr<T, Policy>::operator=(SharedPtr<Y, Policy>&& r) noexcept {
+    SharedPtr<T, Policy>(std::move(r)).Swap(*this);
+    return *this;
 }
 
-template <typename T>
+// Stays empty if other has already expired.
+template <typename T, typename Policy>
+SharedPtr<T, Policy>::SharedPtr(const WeakPtr<T, Policy>& other) noexcept {
+    if (other.control_ && other.control_->TryAddStrongPtr()) {
+        ptr_ = other.ptr_;
+        control_ = other.control_;
+    }
+}
+
+template <typename T, typename Policy>
 template <typename Y, typename Deleter>
-void SharedPtr<T>::Reset(Y* p, Deleter deleter) noexcept {
-    SharedPtr<T>(p, deleter).Swap(*this);
+SharedPtr<T, Policy>::SharedPtr(UniquePtr<Y, Deleter>&& other) {
+    using Element = typename UniquePtr<Y, Deleter>::element_type;
+    if (other) {
+        // The block is created before the UniquePtr lets go, so a failed allocation
+        // leaves the object with its owner.
+        control_ = new ControlBlock<Element, Deleter, Policy>(other.Get(),
+                                                              std::move(other.GetDeleter()));
+        ptr_ = other.Release();
+        control_->AddStrongPtr();
+        HookSharedFromThis(ptr_);
+    }
 }
 
-template <typename T>
-SharedPtr<T>::SharedPtr(const WeakPtr<T>& other) noexcept {
-    control_ = other.control_;
+template <typename T, typename Policy>
+template <typename Y, typename Deleter>
+SharedPtr<T, Policy>& SharedPtr<T, Policy>::operator=(UniquePtr<Y, Deleter>&& r) {
+    SharedPtr<T, Policy>(std::move(r)).Swap(*this);
+    return *this;
+}
 
-    control_->SetValues(other.control_->GetStrongCount(), other.control_->GetWeakCount());
-    control_->AddStrongPtr();
+template <typename T, typename Policy>
+void SharedPtr<T, Policy>::Reset() noexcept {
+    SharedPtr<T, Policy>().Swap(*this);
 }
 
-template <typename T>
+template <typename T, typename Policy>
 template <typename Y>
-WeakPtr<T>::WeakPtr(const SharedPtr<Y>& other) {
-    control_ = new ControlBlock<T>();
-    control_->SetPtr(other.control_->GetPtr());
-    control_->SetValues(other.control_->GetStrongCount(), other.control_->GetWeakCount());
+void SharedPtr<T, Policy>::Reset(Y* p) noexcept {
+    SharedPtr<T, Policy>(p).Swap(*this);
+}
 
-    control_->AddWeakPtr();
+template <typename T, typename Policy>
+template <typename Y, typename Deleter>
+void SharedPtr<T, Policy>::Reset(Y* p, Deleter deleter) noexcept {
+    SharedPtr<T, Policy>(p, deleter).Swap(*this);
 }
 
-template <typename T>
-WeakPtr<T>::WeakPtr(const WeakPtr& other) noexcept {
-    control_ = new ControlBlock<T>();
-    control_->SetPtr(other.control_->GetPtr());
-    control_->SetValues(other.control_->GetStrongCount(), other.control_->GetWeakCount());
+template <typename T, typename Policy>
+void SharedPtr<T, Policy>::Swap(SharedPtr& other) noexcept {
+    std::swap(ptr_, other.ptr_);
+    std::swap(control_, other.control_);
+}
 
-    control_->AddWeakPtr();
+template <typename T, typename Policy>
+T* SharedPtr<T, Policy>::Get() const noexcept {
+    return ptr_;
 }
 
-template <typename T>
-WeakPtr<T>::WeakPtr(WeakPtr&& other) noexcept {
-    control_ = new ControlBlock<T>();
-    control_->SetPtr(other.control_->GetPtr());
-    control_->SetValues(other.control_->GetStrongCount(), other.control_->GetWeakCount());
+template <typename T, typename Policy>
+int64_t SharedPtr<T, Policy>::UseCount() const noexcept {
+    return control_ ? static_cast<int64_t>(control_->GetStrongCount()) : 0;
+}
 
-    other.control_.SetPtr(nullptr);
-    other.control_.SetValues(0, 0);
+template <typename T, typename Policy>
+T& SharedPtr<T, Policy>::operator*() const noexcept {
+    return *ptr_;
 }
 
-template <typename T>
-template <typename Y>
-WeakPtr<T>& WeakPtr<T>::operator=(const SharedPtr<Y>& other) {
-    control_ = other.control_;
+template <typename T, typename Policy>
+T* SharedPtr<T, Policy>::operator->() const noexcept {
+    return ptr_;
+}
 
-    control_->AddWeakPtr();
-    return *this;
+template <typename T, typename Policy>
+T& SharedPtr<T, Policy>::operator[](std::ptrdiff_t idx) const {
+    return ptr_[idx];
 }
 
-template <typename T>
-WeakPtr<T>& WeakPtr<T>::operator=(const WeakPtr& other) noexcept {
-    if (&other == this) {
-        return *this;
-    }
+template <typename T, typename U, typename Policy>
+SharedPtr<T, Policy> StaticPointerCast(const SharedPtr<U, Policy>& r) noexcept {
+    return SharedPtr<T, Policy>(r, static_cast<T*>(r.Get()));
+}
 
-    if (control_) {
-        control_->DelWeak();
+// Empty if r does not point to a T.
+template <typename T, typename U, typename Policy>
+SharedPtr<T, Policy> DynamicPointerCast(const SharedPtr<U, Policy>& r) noexcept {
+    if (auto p = dynamic_cast<T*>(r.Get())) {
+        return SharedPtr<T, Policy>(r, p);
     }
+    return SharedPtr<T, Policy>();
+}
 
-    control_->SetPtr(other.control_->GetPtr());
-    control_->SetValues(other.control_->GetStrongCount(), other.control_->GetWeakCount());
-
-    control_->AddWeakPtr();
-    return *this;
+template <typename T, typename U, typename Policy>
+SharedPtr<T, Policy> ConstPointerCast(const SharedPtr<U, Policy>& r) noexcept {
+    return SharedPtr<T, Policy>(r, const_cast<T*>(r.Get()));
 }
+// SharedPtr
 
-template <typename T>
-WeakPtr<T>& WeakPtr<T>::operator=(WeakPtr&& other) noexcept {
-    if (&other == this) {
-        return *this;
+// WeakPtr
+template <typename T, typename Policy>
+class WeakPtr {
+
+public:
+    // Special-member functions
+    constexpr WeakPtr() noexcept = default;
+    template <typename Y>
+    explicit WeakPtr(const SharedPtr<Y, Policy>& other);
+    WeakPtr(const WeakPtr& other) noexcept;
+    WeakPtr(WeakPtr&& other) noexcept;
+    template <typename Y>
+    WeakPtr& operator=(const SharedPtr<Y, Policy>& other);
+    WeakPtr& operator=(const WeakPtr& other) noexcept;
+    WeakPtr& operator=(WeakPtr&& other) noexcept;
+
+    ~WeakPtr();
+
+    // Modifiers
+    void Reset() noexcept;
+    void Swap(WeakPtr<T, Policy>& other) noexcept;
+
+    // Observers
+    bool Expired() const noexcept;
+    SharedPtr<T, Policy> Lock() const noexcept;
+
+    template <typename U, typename P>
+    friend class SharedPtr;
+
+    template <typename U, typename P>
+    friend class WeakPtr;
+
+private:
+    T* ptr_ = nullptr;
+    ControlBlockBase<Policy>* control_ = nullptr;
+};
+
+template <typename T, typename Policy>
+template <typename Y>
+WeakPtr<T, Policy>::WeakPtr(const SharedPtr<Y, Policy>& other)
+    : ptr_(other.ptr_), control_(other.control_) {
+    if (control_) {
+        control_->AddWeakPtr();
     }
+}
 
+template <typename T, typename Policy>
+WeakPtr<T, Policy>::WeakPtr(const WeakPtr& other) noexcept
+    : ptr_(other.ptr_), control_(other.control_) {
     if (control_) {
-        control_->DelWeak();
+        control_->AddWeakPtr();
     }
+}
+
+template <typename T, typename Policy>
+WeakPtr<T, Policy>::WeakPtr(WeakPtr&& other) noexcept : ptr_(other.ptr_), control_(other.control_) {
+    other.ptr_ = nullptr;
+    other.control_ = nullptr;
+}
 
-    control_ = new ControlBlock<T>();
-    control_->SetPtr(other.control_->GetPtr());
-    control_->SetValues(other.control_->GetStrongCount(), other.control_->GetWeakCount());
+template <typename T, typename Policy>
+template <typename Y>
+WeakPtr<T, Policy>& WeakPtr<T, Policy>::operator=(const SharedPtr<Y, Policy>& other) {
+    WeakPtr<T, Policy>(other).Swap(*this);
+    return *this;
+}
 
-    other.control_.SetPtr(nullptr);
-    other.control_.SetValues(0, 0);
+template <typename T, typename Policy>
+WeakPtr<T, Policy>& WeakPtr<T, Policy>::operator=(const WeakPtr& other) noexcept {
+    WeakPtr<T, Policy>(other).Swap(*this);
+    return *this;
 }
 
-template <typename T>
-WeakPtr<T>::~WeakPtr() {
-    control_->DelWeak();
+template <typename T, typename Policy>
+WeakPtr<T, Policy>& WeakPtr<T, Policy>::operator=(WeakPtr&& other) noexcept {
+    WeakPtr<T, Policy>(std::move(other)).Swap(*this);
+    return *this;
 }
 
-template <typename T>
-void WeakPtr<T>::Reset() noexcept {
+template <typename T, typename Policy>
+WeakPtr<T, Policy>::~WeakPtr() {
     if (control_) {
-        control_->SetPtr(nullptr);
-        control_->SetValues(0, 0);
+        control_->DelWeak();
     }
 }
 
-template <typename T>
-void WeakPtr<T>::Swap(WeakPtr<T>& other) noexcept {
-    auto tmp = other.control_;
-    other.control_ = control_;
-    control_ = tmp;
+template <typename T, typename Policy>
+void WeakPtr<T, Policy>::Reset() noexcept {
+    WeakPtr<T, Policy>().Swap(*this);
 }
 
-template <typename T>
-bool WeakPtr<T>::Expired() const noexcept {
+template <typename T, typename Policy>
+void WeakPtr<T, Policy>::Swap(WeakPtr<T, Policy>& other) noexcept {
+    std::swap(ptr_, other.ptr_);
+    std::swap(control_, other.control_);
+}
+
+template <typename T, typename Policy>
+bool WeakPtr<T, Policy>::Expired() const noexcept {
     if (control_) {
         return control_->GetStrongCount() == 0;
     }
     return true;
 }
 
-template <typename T>
-SharedPtr<T> WeakPtr<T>::Lock() const noexcept {
-    if (Expired()) {
-        return SharedPtr<T>();
-    } else {
-        return SharedPtr<T>(*this);
-    }
+template <typename T, typename Policy>
+SharedPtr<T, Policy> WeakPtr<T, Policy>::Lock() const noexcept {
+    // Checking Expired() first would race with the last owner, the upgrade itself
+    // has to be the check.
+    return SharedPtr<T, Policy>(*this);
 }
+// WeakPtr
+
+// EnableSharedFromThis
+// Derive from EnableSharedFromThis<T> to let a T that is already owned by a SharedPtr
+// hand out further SharedPtrs to itself, sharing the existing control block.
+template <typename T, typename Policy>
+class EnableSharedFromThis {
+public:
+    // Empty when the object is not (or no longer) owned by a SharedPtr.
+    SharedPtr<T, Policy> SharedFromThis() {
+        return SharedPtr<T, Policy>(weak_this_);
+    }
+
+    SharedPtr<const T, Policy> SharedFromThis() const {
+        return SharedPtr<const T, Policy>(weak_this_.Lock(), static_cast<const T*>(this));
+    }
+
+    WeakPtr<T, Policy> WeakFromThis() const noexcept {
+        return weak_this_;
+    }
+
+    template <typename U, typename P>
+    friend class SharedPtr;
+
+protected:
+    constexpr EnableSharedFromThis() noexcept = default;
+
+    // Copies are owned separately, they must not inherit the source's owner.
+    EnableSharedFromThis(const EnableSharedFromThis&) noexcept {
+    }
+
+    EnableSharedFromThis& operator=(const EnableSharedFromThis&) noexcept {
+        return *this;
+    }
+
+    ~EnableSharedFromThis() = default;
+
+private:
+    mutable WeakPtr<T, Policy> weak_this_;
+};
+// EnableSharedFromThis
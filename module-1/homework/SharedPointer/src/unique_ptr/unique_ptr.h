@@ -0,0 +1,267 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace detail {
+
+// Pointer plus deleter. Empty, non-final deleters become a base class and take no
+// space, so UniquePtr<T> with std::default_delete or a lambda is one pointer wide.
+template <typename Pointer, typename Deleter,
+          bool = std::is_empty_v<Deleter> && !std::is_final_v<Deleter>>
+class PointerAndDeleter : private Deleter {
+public:
+    PointerAndDeleter() = default;
+
+    template <typename D>
+    PointerAndDeleter(Pointer ptr, D&& deleter)
+        : Deleter(std::forward<D>(deleter)), ptr_(ptr) {
+    }
+
+    Pointer& GetPointer() noexcept {
+        return ptr_;
+    }
+
+    const Pointer& GetPointer() const noexcept {
+        return ptr_;
+    }
+
+    Deleter& GetDeleter() noexcept {
+        return *this;
+    }
+
+    const Deleter& GetDeleter() const noexcept {
+        return *this;
+    }
+
+private:
+    Pointer ptr_ = nullptr;
+};
+
+template <typename Pointer, typename Deleter>
+class PointerAndDeleter<Pointer, Deleter, false> {
+public:
+    PointerAndDeleter() = default;
+
+    template <typename D>
+    PointerAndDeleter(Pointer ptr, D&& deleter) : ptr_(ptr), deleter_(std::forward<D>(deleter)) {
+    }
+
+    Pointer& GetPointer() noexcept {
+        return ptr_;
+    }
+
+    const Pointer& GetPointer() const noexcept {
+        return ptr_;
+    }
+
+    Deleter& GetDeleter() noexcept {
+        return deleter_;
+    }
+
+    const Deleter& GetDeleter() const noexcept {
+        return deleter_;
+    }
+
+private:
+    Pointer ptr_ = nullptr;
+    Deleter deleter_;
+};
+
+}  // namespace detail
+
+// UniquePtr
+template <typename T, typename Deleter = std::default_delete<T>>
+class UniquePtr {
+public:
+    using pointer = T*;
+    using element_type = T;
+    using deleter_type = Deleter;
+
+    constexpr UniquePtr() noexcept = default;
+    constexpr UniquePtr(std::nullptr_t) noexcept {  // NOLINT
+    }
+    explicit UniquePtr(T* p) noexcept : data_(p, Deleter()) {
+    }
+    UniquePtr(T* p, const Deleter& deleter) noexcept : data_(p, deleter) {
+    }
+    UniquePtr(T* p, Deleter&& deleter) noexcept : data_(p, std::move(deleter)) {
+    }
+
+    UniquePtr(const UniquePtr&) = delete;
+    UniquePtr& operator=(const UniquePtr&) = delete;
+
+    UniquePtr(UniquePtr&& other) noexcept
+        : data_(other.Release(), std::forward<Deleter>(other.GetDeleter())) {
+    }
+
+    template <typename Y, typename E,
+              typename = std::enable_if_t<std::is_convertible_v<Y*, T*> && !std::is_array_v<Y>>>
+    UniquePtr(UniquePtr<Y, E>&& other) noexcept  // NOLINT
+        : data_(other.Release(), std::forward<E>(other.GetDeleter())) {
+    }
+
+    UniquePtr& operator=(UniquePtr&& other) noexcept {
+        Reset(other.Release());
+        GetDeleter() = std::forward<Deleter>(other.GetDeleter());
+        return *this;
+    }
+
+    template <typename Y, typename E>
+    UniquePtr& operator=(UniquePtr<Y, E>&& other) noexcept {
+        Reset(other.Release());
+        GetDeleter() = std::forward<E>(other.GetDeleter());
+        return *this;
+    }
+
+    UniquePtr& operator=(std::nullptr_t) noexcept {
+        Reset();
+        return *this;
+    }
+
+    ~UniquePtr() {
+        Reset();
+    }
+
+    // Modifiers
+    T* Release() noexcept {
+        return std::exchange(data_.GetPointer(), nullptr);
+    }
+
+    void Reset(T* p = nullptr) noexcept {
+        T* old = std::exchange(data_.GetPointer(), p);
+        if (old != nullptr) {
+            GetDeleter()(old);
+        }
+    }
+
+    void Swap(UniquePtr& other) noexcept {
+        std::swap(data_, other.data_);
+    }
+
+    // Observers
+    T* Get() const noexcept {
+        return data_.GetPointer();
+    }
+
+    Deleter& GetDeleter() noexcept {
+        return data_.GetDeleter();
+    }
+
+    const Deleter& GetDeleter() const noexcept {
+        return data_.GetDeleter();
+    }
+
+    T& operator*() const noexcept {
+        return *Get();
+    }
+
+    T* operator->() const noexcept {
+        return Get();
+    }
+
+    explicit operator bool() const noexcept {
+        return Get() != nullptr;
+    }
+
+private:
+    detail::PointerAndDeleter<T*, Deleter> data_;
+};
+
+// Owns an array allocated with new[], indexes instead of dereferencing.
+template <typename T, typename Deleter>
+class UniquePtr<T[], Deleter> {
+public:
+    using pointer = T*;
+    using element_type = T;
+    using deleter_type = Deleter;
+
+    constexpr UniquePtr() noexcept = default;
+    constexpr UniquePtr(std::nullptr_t) noexcept {  // NOLINT
+    }
+    explicit UniquePtr(T* p) noexcept : data_(p, Deleter()) {
+    }
+    UniquePtr(T* p, const Deleter& deleter) noexcept : data_(p, deleter) {
+    }
+    UniquePtr(T* p, Deleter&& deleter) noexcept : data_(p, std::move(deleter)) {
+    }
+
+    UniquePtr(const UniquePtr&) = delete;
+    UniquePtr& operator=(const UniquePtr&) = delete;
+
+    UniquePtr(UniquePtr&& other) noexcept
+        : data_(other.Release(), std::forward<Deleter>(other.GetDeleter())) {
+    }
+
+    UniquePtr& operator=(UniquePtr&& other) noexcept {
+        Reset(other.Release());
+        GetDeleter() = std::forward<Deleter>(other.GetDeleter());
+        return *this;
+    }
+
+    UniquePtr& operator=(std::nullptr_t) noexcept {
+        Reset();
+        return *this;
+    }
+
+    ~UniquePtr() {
+        Reset();
+    }
+
+    // Modifiers
+    T* Release() noexcept {
+        return std::exchange(data_.GetPointer(), nullptr);
+    }
+
+    void Reset(T* p = nullptr) noexcept {
+        T* old = std::exchange(data_.GetPointer(), p);
+        if (old != nullptr) {
+            GetDeleter()(old);
+        }
+    }
+
+    void Swap(UniquePtr& other) noexcept {
+        std::swap(data_, other.data_);
+    }
+
+    // Observers
+    T* Get() const noexcept {
+        return data_.GetPointer();
+    }
+
+    Deleter& GetDeleter() noexcept {
+        return data_.GetDeleter();
+    }
+
+    const Deleter& GetDeleter() const noexcept {
+        return data_.GetDeleter();
+    }
+
+    T& operator[](std::size_t idx) const {
+        return Get()[idx];
+    }
+
+    explicit operator bool() const noexcept {
+        return Get() != nullptr;
+    }
+
+private:
+    detail::PointerAndDeleter<T*, Deleter> data_;
+};
+// UniquePtr
+
+// MakeUnique
+template <typename T, typename... Args>
+std::enable_if_t<!std::is_array_v<T>, UniquePtr<T>> MakeUnique(Args&&... args) {
+    return UniquePtr<T>(new T(std::forward<Args>(args)...));
+}
+
+// Value-initialized array of size elements.
+template <typename T>
+std::enable_if_t<std::is_array_v<T> && std::extent_v<T> == 0, UniquePtr<T>> MakeUnique(
+    std::size_t size) {
+    return UniquePtr<T>(new std::remove_extent_t<T>[size]());
+}
+// MakeUnique
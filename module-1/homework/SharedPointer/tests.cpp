@@ -1,8 +1,15 @@
 #include <algorithm>
+#include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "gtest/gtest.h"
+#include "src/atomic_shared_ptr/atomic_shared_ptr.h"
+#include "src/intrusive_ptr/intrusive_ptr.h"
+#include "src/reclaimer/reclaimer.h"
 #include "src/shared_ptr/shared_ptr.h"
+#include "src/unique_ptr/unique_ptr.h"
 
 // WeakPtr
 
@@ -48,6 +55,51 @@ TEST(WeakLock, Test2) {
     ASSERT_FALSE(w.Lock());
 }
 
+TEST(WeakLock, Test3) {
+    struct Payload {
+        explicit Payload(int* destroyed) : destroyed(destroyed) {
+        }
+        ~Payload() {
+            ++*destroyed;
+        }
+        int* destroyed;
+    };
+
+    int destroyed = 0;
+    WeakPtr<Payload> w1;
+    WeakPtr<Payload> w2;
+    {
+        SharedPtr<Payload> s1(new Payload(&destroyed));
+        auto s2 = MakeShared<Payload>(&destroyed);
+        w1 = s1;
+        w2 = s2;
+    }
+    ASSERT_EQ(destroyed, 2);
+    ASSERT_FALSE(w1.Lock() || w2.Lock());
+}
+
+TEST(WeakLock, Test4) {
+    for (int i = 0; i < 100; ++i) {
+        auto sp = MakeShared<std::string>("hello");
+        WeakPtr<std::string> w(sp);
+        std::vector<std::thread> threads;
+        for (int j = 0; j < 4; ++j) {
+            threads.emplace_back([&w] {
+                for (int k = 0; k < 100; ++k) {
+                    if (auto locked = w.Lock()) {
+                        ASSERT_EQ(*locked, "hello");
+                    }
+                }
+            });
+        }
+        sp.Reset();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        ASSERT_TRUE(w.Expired());
+    }
+}
+
 // SharedPtr
 TEST(SharedMoveConstructor, Test1) {
     class Contrainer {};
@@ -159,6 +211,350 @@ TEST(SharedBoolOperator, Test2) {
     ASSERT_FALSE(s1);
 }
 
+TEST(MakeShared, Test1) {
+    struct Counted {
+        Counted(std::string name, int* destroyed) : name(std::move(name)), destroyed(destroyed) {
+        }
+        ~Counted() {
+            ++*destroyed;
+        }
+        std::string name;
+        int* destroyed;
+    };
+
+    int destroyed = 0;
+    {
+        auto s1 = MakeShared<Counted>("hello", &destroyed);
+        SharedPtr<Counted> s2 = s1;
+        ASSERT_TRUE(s1->name == "hello" && s2.UseCount() == 2);
+    }
+    ASSERT_EQ(destroyed, 1);
+}
+
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+
+    explicit CountingAllocator(int* allocations) : allocations(allocations) {
+    }
+
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>& other) : allocations(other.allocations) {
+    }
+
+    T* allocate(std::size_t n) {
+        ++*allocations;
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, std::size_t n) {
+        --*allocations;
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    int* allocations;
+};
+
+TEST(AllocateShared, Test1) {
+    int allocations = 0;
+    {
+        auto s1 = AllocateShared<std::string>(CountingAllocator<char>(&allocations), "hello");
+        SharedPtr<std::string> s2 = s1;
+        WeakPtr<std::string> w(s1);
+        ASSERT_TRUE(*s2 == "hello" && s1.UseCount() == 2);
+        ASSERT_EQ(allocations, 1);
+    }
+    ASSERT_EQ(allocations, 0);
+}
+
+struct Pooled {
+    int value = 0;
+};
+
+template <>
+struct PooledControlBlock<Pooled> : std::true_type {};
+
+TEST(PooledControlBlock, Test1) {
+    using Pool = ControlBlockPool<sizeof(ControlBlock<Pooled>), alignof(ControlBlock<Pooled>)>;
+    for (int i = 0; i < 1000; ++i) {
+        SharedPtr<Pooled> s1(new Pooled{i});
+        SharedPtr<Pooled> s2 = s1;
+        ASSERT_TRUE(s2->value == i && s1.UseCount() == 2);
+    }
+    std::size_t capacity = Pool::GetCapacity();
+    ASSERT_GT(capacity, 0);
+
+    SharedPtr<Pooled> s3(new Pooled{1});
+    s3.Reset(new Pooled{2});
+    ASSERT_EQ(Pool::GetCapacity(), capacity);
+}
+
+TEST(MakeLocalShared, Test1) {
+    SharedPtr<std::string, NonAtomicRefCount> s1 = MakeLocalShared<std::string>("hello");
+    WeakPtr<std::string, NonAtomicRefCount> w;
+    {
+        auto s2 = s1;
+        w = s2;
+        ASSERT_TRUE(*s2 == "hello" && s1.UseCount() == 2);
+    }
+    ASSERT_EQ(s1.UseCount(), 1);
+    s1.Reset();
+    ASSERT_TRUE(w.Expired());
+}
+
+TEST(AtomicSharedPtr, Test1) {
+    auto first = MakeShared<std::string>("first");
+    AtomicSharedPtr<std::string> slot(first);
+    ASSERT_TRUE(slot.IsLockFree());
+    ASSERT_EQ(slot.Load().Get(), first.Get());
+    ASSERT_EQ(first.UseCount(), 2);
+
+    auto second = MakeShared<std::string>("second");
+    SharedPtr<std::string> expected = second;
+    ASSERT_FALSE(slot.CompareExchange(expected, MakeShared<std::string>("third")));
+    ASSERT_EQ(expected.Get(), first.Get());
+
+    ASSERT_TRUE(slot.CompareExchange(expected, second));
+    ASSERT_EQ(*slot.Load(), "second");
+    ASSERT_EQ(first.UseCount(), 2);
+    expected.Reset();
+    ASSERT_EQ(first.UseCount(), 1);
+
+    ASSERT_EQ(slot.Exchange(SharedPtr<std::string>()).Get(), second.Get());
+    ASSERT_FALSE(slot.Load());
+    ASSERT_EQ(second.UseCount(), 1);
+}
+
+TEST(AtomicSharedPtr, Test2) {
+    AtomicSharedPtr<std::string> slot(MakeShared<std::string>("0"));
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i) {
+        readers.emplace_back([&slot] {
+            for (int j = 0; j < 10000; ++j) {
+                auto snapshot = slot.Load();
+                ASSERT_TRUE(snapshot && !snapshot->empty());
+            }
+        });
+    }
+    for (int i = 1; i <= 1000; ++i) {
+        slot.Store(MakeShared<std::string>(std::to_string(i)));
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    ASSERT_EQ(*slot.Load(), "1000");
+}
+
+TEST(SharedAliasing, Test1) {
+    auto buffer = MakeShared<std::vector<int>>(1000, 7);
+    SharedPtr<int> slice(buffer, buffer->data() + 500);
+    ASSERT_TRUE(*slice == 7 && buffer.UseCount() == 2);
+
+    WeakPtr<std::vector<int>> w(buffer);
+    buffer.Reset();
+    ASSERT_FALSE(w.Expired());
+    ASSERT_EQ(slice.Get()[499], 7);
+    slice.Reset();
+    ASSERT_TRUE(w.Expired());
+}
+
+struct Base {
+    virtual ~Base() = default;
+};
+
+struct Derived : Base {
+    int value = 42;
+};
+
+TEST(SharedPointerCast, Test1) {
+    SharedPtr<Base> base = MakeShared<Derived>();
+    auto derived = DynamicPointerCast<Derived>(base);
+    ASSERT_TRUE(derived && derived->value == 42 && base.UseCount() == 2);
+    ASSERT_EQ(StaticPointerCast<Derived>(base).Get(), derived.Get());
+    ASSERT_FALSE(DynamicPointerCast<Derived>(SharedPtr<Base>(new Base)));
+
+    SharedPtr<const Derived> constant = derived;
+    ASSERT_EQ(ConstPointerCast<Derived>(constant).Get(), derived.Get());
+}
+
+struct Self : EnableSharedFromThis<Self> {
+    SharedPtr<Self> Get() {
+        return SharedFromThis();
+    }
+};
+
+TEST(EnableSharedFromThis, Test1) {
+    auto s1 = MakeShared<Self>();
+    auto s2 = s1->Get();
+    ASSERT_TRUE(s2.Get() == s1.Get() && s1.UseCount() == 2);
+
+    SharedPtr<Self> s3(new Self);
+    ASSERT_EQ(s3->Get().Get(), s3.Get());
+    ASSERT_EQ(s3->WeakFromThis().Lock().Get(), s3.Get());
+
+    Self unowned;
+    ASSERT_FALSE(unowned.Get());
+}
+
+struct Intrusive : RefCounted<Intrusive> {
+    Intrusive(std::string name, int* destroyed) : name(std::move(name)), destroyed(destroyed) {
+    }
+    ~Intrusive() {
+        ++*destroyed;
+    }
+    std::string name;
+    int* destroyed;
+};
+
+TEST(IntrusivePtr, Test1) {
+    int destroyed = 0;
+    {
+        auto p1 = MakeIntrusive<Intrusive>("hello", &destroyed);
+        IntrusivePtr<Intrusive> p2 = p1;
+        // The count lives in the object, so adopting the raw pointer again is fine.
+        IntrusivePtr<Intrusive> p3(p1.Get());
+        ASSERT_TRUE(p3->name == "hello" && p1.UseCount() == 3);
+
+        IntrusivePtr<Intrusive> p4 = std::move(p2);
+        ASSERT_TRUE(!p2 && p4.UseCount() == 3);
+        p3.Reset();
+        ASSERT_EQ(p1.UseCount(), 2);
+    }
+    ASSERT_EQ(destroyed, 1);
+}
+
+TEST(IntrusivePtr, Test2) {
+    struct Local : RefCounted<Local, NonAtomicRefCount> {
+        int value = 0;
+    };
+    IntrusivePtr<Local> p1 = MakeIntrusive<Local>();
+    IntrusivePtr<const Local> p2 = p1;
+    p1->value = 42;
+    ASSERT_TRUE(p2->value == 42 && p2.UseCount() == 2);
+}
+
+TEST(DeferredDelete, Test1) {
+    ReclaimerOptions options;
+    options.capacity = 2;
+    options.start_worker = false;
+    Reclaimer reclaimer(options);
+
+    int destroyed = 0;
+    for (int i = 0; i < 3; ++i) {
+        SharedPtr<Intrusive> p(new Intrusive("deferred", &destroyed),
+                               DeferredDelete<Intrusive>(reclaimer));
+    }
+    // The third object did not fit into the queue and was destroyed in place.
+    ASSERT_TRUE(destroyed == 1 && reclaimer.GetPending() == 2);
+    ASSERT_EQ(reclaimer.GetInlineReclaims(), 1);
+
+    ASSERT_EQ(reclaimer.Collect(), 2);
+    ASSERT_TRUE(destroyed == 3 && reclaimer.GetPending() == 0);
+}
+
+TEST(DeferredDelete, Test2) {
+    int destroyed = 0;
+    {
+        ReclaimerOptions options;
+        options.epoch = std::chrono::milliseconds(1);
+        Reclaimer reclaimer(options);
+        for (int i = 0; i < 100; ++i) {
+            SharedPtr<Intrusive> p(new Intrusive("deferred", &destroyed),
+                                   DeferredDelete<Intrusive>(reclaimer));
+        }
+        while (reclaimer.GetEpoch() < 2) {
+            std::this_thread::yield();
+        }
+    }
+    ASSERT_EQ(destroyed, 100);
+}
+
+struct Traced {
+    SharedPtr<Traced, InstrumentedRefCount<>> next;
+};
+
+TEST(InstrumentedRefCount, Test1) {
+    auto& registry = RefCountRegistry::Instance();
+    auto s1 = MakeSharedWithPolicy<Traced, InstrumentedRefCount<>>();
+    {
+        auto s2 = s1;
+        WeakPtr<Traced, InstrumentedRefCount<>> w(s2);
+        ASSERT_TRUE(w.Lock());
+    }
+    std::thread([copy = s1] {}).join();
+
+    auto stats = registry.GetStats().at("Traced");
+    ASSERT_TRUE(stats.created == 1 && stats.destroyed == 0);
+    ASSERT_TRUE(stats.strong_increments == 4 && stats.strong_decrements == 3);
+    ASSERT_TRUE(stats.weak_increments == 1 && stats.weak_decrements == 1);
+    ASSERT_GE(stats.handoffs, 1);
+
+    s1.Reset();
+    stats = registry.GetStats().at("Traced");
+    ASSERT_TRUE(stats.destroyed == 1 && stats.strong_decrements == 4);
+}
+
+TEST(InstrumentedRefCount, Test2) {
+    auto& registry = RefCountRegistry::Instance();
+    auto s1 = MakeSharedWithPolicy<Traced, InstrumentedRefCount<>>();
+    auto s2 = MakeSharedWithPolicy<Traced, InstrumentedRefCount<>>();
+    s1->next = s2;
+    ASSERT_TRUE(registry.FindCycles().empty());
+
+    s2->next = s1;
+    auto cycles = registry.FindCycles();
+    ASSERT_EQ(cycles.size(), 1);
+    ASSERT_EQ(cycles[0], std::vector<std::string>({"Traced", "Traced"}));
+    ASSERT_NE(registry.Report().find("cycle: Traced, Traced"), std::string::npos);
+
+    s2->next.Reset();
+    ASSERT_TRUE(registry.FindCycles().empty());
+}
+
+TEST(UniquePtr, Test1) {
+    int destroyed = 0;
+    auto deleter = [&destroyed](Intrusive* p) {
+        ++destroyed;
+        delete p;
+    };
+    static_assert(sizeof(UniquePtr<int>) == sizeof(int*));
+    static_assert(sizeof(UniquePtr<int[]>) == sizeof(int*));
+
+    UniquePtr<Intrusive, decltype(deleter)> u1(new Intrusive("unique", &destroyed), deleter);
+    auto u2 = std::move(u1);
+    ASSERT_TRUE(!u1 && u2->name == "unique");
+    u2.Reset();
+    ASSERT_EQ(destroyed, 2);
+
+    auto array = MakeUnique<int[]>(8);
+    array[7] = 42;
+    ASSERT_TRUE(array[0] == 0 && array[7] == 42);
+
+    UniquePtr<Base> base = MakeUnique<Derived>();
+    ASSERT_EQ(static_cast<Derived&>(*base).value, 42);
+}
+
+TEST(UniquePtr, Test2) {
+    int deleted = 0;
+    auto deleter = [&deleted](int* p) {
+        ++deleted;
+        delete p;
+    };
+    UniquePtr<int, decltype(deleter)> u(new int(42), deleter);
+    int* raw = u.Get();
+
+    SharedPtr<int> s1 = std::move(u);
+    ASSERT_TRUE(!u && s1.Get() == raw && s1.UseCount() == 1);
+    SharedPtr<int> s2 = s1;
+    s1.Reset();
+    ASSERT_EQ(deleted, 0);
+    s2.Reset();
+    ASSERT_EQ(deleted, 1);
+
+    SharedPtr<int> s3 = MakeUnique<int[]>(4);
+    ASSERT_EQ(s3[3], 0);
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
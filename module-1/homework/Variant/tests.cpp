@@ -1,8 +1,11 @@
+#include <array>
 #include <cmath>
+#include <stdexcept>
 #include <string>
 
 #include "gtest/gtest.h"
 #include "variant.h"
+#include "variant_vector.h"
 
 TEST(Get, Test1) {
     task::Variant<int32_t, double, std::string> v;
@@ -28,6 +31,271 @@ TEST(Get, Test4) {
     ASSERT_NEAR(task::Get<1>(v), 12.0, 1e-5);
 }
 
+template <typename... Visitors>
+struct Overloaded : Visitors... {
+    using Visitors::operator()...;
+};
+
+template <typename... Visitors>
+Overloaded(Visitors...) -> Overloaded<Visitors...>;
+
+TEST(Visit, Test1) {
+    task::Variant<int32_t, double, std::string> v;
+    v = "Hello world";
+    auto size = task::Visit(Overloaded{[](const std::string& s) { return s.size(); },
+                                       [](auto) { return size_t{0}; }},
+                            v);
+    ASSERT_EQ(v.Index(), 2);
+    ASSERT_EQ(size, 11);
+
+    task::Visit([](auto& value) { value = {}; }, v);
+    ASSERT_TRUE(task::Get<std::string>(v).empty());
+}
+
+TEST(Visit, Test2) {
+    task::Variant<int32_t, std::string> v1;
+    task::Variant<double, int32_t, std::string> v2;
+    task::Variant<double, int32_t, std::string> v3;
+    v1 = 2;
+    v2 = 0.5;
+    v3 = "Hello world";
+    auto product = [](auto lhs, auto rhs) -> double {
+        if constexpr (std::is_arithmetic_v<decltype(lhs)> && std::is_arithmetic_v<decltype(rhs)>) {
+            return lhs * rhs;
+        } else {
+            return -1;
+        }
+    };
+    ASSERT_NEAR(task::Visit(product, v1, v2), 1.0, 1e-5);
+    ASSERT_NEAR(task::Visit(product, v1, v3), -1.0, 1e-5);
+}
+
+template <size_t N>
+struct Tag {
+    static constexpr size_t kValue = N;
+};
+
+TEST(Visit, Test3) {
+    // Past the switch, dispatch goes through the function pointer table.
+    task::Variant<Tag<0>, Tag<1>, Tag<2>, Tag<3>, Tag<4>, Tag<5>, Tag<6>, Tag<7>, Tag<8>, Tag<9>> v;
+    auto value = [](auto tag) { return decltype(tag)::kValue; };
+    ASSERT_EQ(task::Visit(value, v), 0);
+    v = Tag<9>();
+    ASSERT_EQ(task::Visit(value, v), 9);
+    v = Tag<4>();
+    ASSERT_EQ(task::Visit(value, v), 4);
+}
+
+template <size_t... Indices>
+task::Variant<Tag<Indices>...> MakeTagVariant(std::index_sequence<Indices...>);
+
+TEST(Layout, Test1) {
+    static_assert(sizeof(task::Variant<char, int8_t>) == 2);
+    static_assert(sizeof(task::Variant<int32_t, float>) == 8);
+    static_assert(sizeof(task::Variant<double, int32_t>) == 16);
+    using Wide = decltype(MakeTagVariant(std::make_index_sequence<300>()));
+    static_assert(sizeof(Wide) == 4);
+
+    using Trivial = task::Variant<int32_t, double, Tag<0>>;
+    static_assert(std::is_trivially_copyable_v<Trivial>);
+    static_assert(std::is_trivially_destructible_v<Trivial>);
+    static_assert(!std::is_trivially_destructible_v<task::Variant<int32_t, std::string>>);
+
+    Trivial v1;
+    v1 = 12.0;
+    Trivial v2 = v1;
+    ASSERT_TRUE(v2.Index() == 1 && task::Get<double>(v2) == 12.0);
+}
+
+struct Heavy {
+    explicit Heavy(size_t size) : data(size, 'x') {
+        ++constructed;
+    }
+
+    Heavy(const Heavy& other) : data(other.data) {
+        ++copied;
+    }
+
+    Heavy(Heavy&& other) noexcept : data(std::move(other.data)) {
+        ++moved;
+    }
+
+    Heavy& operator=(const Heavy&) = default;
+    Heavy& operator=(Heavy&&) = default;
+
+    ~Heavy() {
+        ++destroyed;
+    }
+
+    std::string data;
+    static inline size_t constructed = 0;
+    static inline size_t copied = 0;
+    static inline size_t moved = 0;
+    static inline size_t destroyed = 0;
+};
+
+TEST(Emplace, Test1) {
+    Heavy::constructed = Heavy::copied = Heavy::moved = Heavy::destroyed = 0;
+    {
+        task::Variant<int32_t, Heavy> v;
+        ASSERT_EQ(v.Index(), 0);
+        ASSERT_EQ(v.Emplace<Heavy>(1000).data.size(), 1000);
+        ASSERT_EQ(v.Index(), 1);
+        ASSERT_EQ(Heavy::constructed, 1);
+
+        v.Emplace<1>(10);
+        ASSERT_EQ(Heavy::constructed, 2);
+        ASSERT_EQ(Heavy::destroyed, 1);
+
+        v = 5;
+        ASSERT_EQ(v.Index(), 0);
+        ASSERT_EQ(task::Get<int32_t>(v), 5);
+        ASSERT_EQ(Heavy::destroyed, 2);
+
+        v.Emplace<Heavy>(1);
+    }
+    ASSERT_EQ(Heavy::constructed, 3);
+    ASSERT_EQ(Heavy::destroyed, 3);
+    ASSERT_EQ(Heavy::copied + Heavy::moved, 0);
+}
+
+TEST(Emplace, Test2) {
+    task::Variant<int32_t, double, std::string> v("Hello world");
+    ASSERT_EQ(v.Index(), 2);
+    task::Variant<int32_t, double, std::string> f(1.5f);
+    ASSERT_EQ(f.Index(), 1);
+    static_assert(!std::is_constructible_v<task::Variant<int32_t, int64_t>, double>);
+
+    auto copy = v;
+    ASSERT_EQ(task::Get<std::string>(copy), "Hello world");
+    copy = f;
+    ASSERT_EQ(copy.Index(), 1);
+    v = std::move(copy);
+    ASSERT_NEAR(task::Get<double>(v), 1.5, 1e-5);
+    v = std::string(100, 'a');
+    task::Variant<int32_t, double, std::string> moved(std::move(v));
+    ASSERT_EQ(task::Get<std::string>(moved).size(), 100);
+}
+
+struct ThrowingHeavy {
+    explicit ThrowingHeavy(int32_t) {
+        throw std::runtime_error("ThrowingHeavy");
+    }
+};
+
+TEST(Emplace, Test3) {
+    task::Variant<int32_t, ThrowingHeavy> v(32);
+    ASSERT_THROW(v.Emplace<ThrowingHeavy>(1), std::runtime_error);
+    ASSERT_TRUE(v.ValuelessByException());
+    ASSERT_EQ(v.Index(), task::kVariantNpos);
+    ASSERT_THROW(task::Visit([](const auto&) { return 0; }, v), task::BadVariantAccess);
+
+    task::Variant<int32_t, double> other;
+    ASSERT_THROW(task::Visit([](const auto&, const auto&) { return 0; }, other, v),
+                 task::BadVariantAccess);
+
+    v = 5;
+    ASSERT_EQ(task::Visit([](const auto& value) { return sizeof(value); }, v), 4);
+}
+
+struct Literal {
+    constexpr explicit Literal(int32_t value) : value(value) {
+    }
+
+    constexpr Literal(const Literal& other) : value(other.value + 1) {
+    }
+
+    constexpr ~Literal() {
+    }
+
+    int32_t value;
+};
+
+constexpr int32_t SwitchAlternatives() {
+    task::Variant<int32_t, double, Literal> v;
+    v = 2.5;
+    v.Emplace<Literal>(7);
+    task::Variant<int32_t, double, Literal> copy = v;
+    v = 3;
+    return task::Get<int32_t>(v) + task::Get<Literal>(copy).value;
+}
+
+TEST(Constexpr, Test1) {
+    constexpr task::Variant<int32_t, double> kDefault;
+    static_assert(kDefault.Index() == 0 && task::Get<0>(kDefault) == 0);
+
+    constexpr std::array<task::Variant<int32_t, double>, 3> kTable = {1, 2.5, 3};
+    static_assert(kTable[1].Index() == 1 && task::Get<double>(kTable[1]) == 2.5);
+    static_assert(task::Visit([](auto value) { return value < 3; }, kTable[2]) == false);
+
+    static_assert(SwitchAlternatives() == 3 + 8);
+    ASSERT_EQ(SwitchAlternatives(), 11);
+}
+
+TEST(VariantVector, Test1) {
+    task::VariantVector<int32_t, double, std::string> values;
+    values.PushBack(1);
+    values.PushBack("Hello world");
+    values.PushBack(2.5);
+    values.Emplace<0>(3);
+    values.Emplace<std::string>(3, 'a');
+    values.PushBack(task::Variant<int32_t, double, std::string>(0.5));
+
+    ASSERT_EQ(values.Size(), 6);
+    ASSERT_EQ(values.Index(1), 2);
+    ASSERT_EQ(values.Get<2>(4), "aaa");
+    ASSERT_NEAR(values.Get<1>(5), 0.5, 1e-5);
+    ASSERT_EQ(values.Values<0>().size(), 2);
+    ASSERT_EQ(values.Values<0>()[1], 3);
+
+    auto describe = Overloaded{[](int32_t) { return 'i'; }, [](double) { return 'd'; },
+                               [](const std::string&) { return 's'; }};
+    std::string order;
+    for (size_t i = 0; i < values.Size(); ++i) {
+        order += values.Visit(i, describe);
+    }
+    ASSERT_EQ(order, "isdisd");
+
+    task::Variant<int32_t, double, std::string> valueless;
+    try {
+        valueless.Emplace<std::string>(std::string::npos, 'a');
+    } catch (const std::length_error&) {
+    }
+    ASSERT_TRUE(valueless.ValuelessByException());
+    ASSERT_THROW(values.PushBack(valueless), task::BadVariantAccess);
+    ASSERT_EQ(values.Size(), 6);
+}
+
+TEST(VariantVector, Test2) {
+    task::VariantVector<int32_t, double, std::string> values;
+    for (int32_t i = 0; i < 100; ++i) {
+        if (i % 3 == 0) {
+            values.PushBack(std::to_string(i));
+        } else if (i % 3 == 1) {
+            values.PushBack(i);
+        } else {
+            values.PushBack(i / 2.0);
+        }
+    }
+
+    std::string order;
+    values.VisitAll(Overloaded{[&](int32_t& value) { value *= 2; }, [&](double) {},
+                               [&](const std::string& value) { order += value[0]; }});
+    ASSERT_EQ(values.Get<0>(1), 2);
+    ASSERT_EQ(values.Get<0>(97), 194);
+    ASSERT_EQ(order.size(), 34);
+
+    double sum = 0;
+    const auto& view = values;
+    view.VisitAll(Overloaded{[&](int32_t value) { sum += value; },
+                             [&](double value) { sum += value; }, [](const std::string&) {}});
+    ASSERT_NEAR(sum, 2 * 1617 + 1650 / 2.0, 1e-5);
+
+    values.Clear();
+    ASSERT_TRUE(values.Empty());
+    ASSERT_TRUE(values.Values<2>().empty());
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
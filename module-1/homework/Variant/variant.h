@@ -1,4 +1,10 @@
+#include <array>
+#include <cstdint>
 #include <cstdlib>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <type_traits>
 #include <utility>
 
 #pragma once
@@ -43,28 +49,28 @@ public:
     T head;
     Union<Index + 1, Types...> tail;
 
-    Union() : tail() {
-        if (!std::is_trivially_constructible_v<T>) {
-            new (&head) T();
-        }
+    // Starts with no live alternative, Variant constructs the one it needs. A union
+    // rather than an aligned byte buffer: switching its active member with
+    // std::construct_at is allowed in constant expressions, casting raw bytes is not.
+    constexpr Union() {
     }
 
-    ~Union() {
-        if (!std::is_trivially_destructible_v<T>) {
-            head.~T();
-        }
+    template <typename... Args>
+    constexpr explicit Union(InPlaceIndex<0>, Args&&... args) : head(std::forward<Args>(args)...) {
     }
-};
 
-struct AssignUnion {
-    template <size_t Index, typename U, size_t UnionIndex, typename Head, typename... Tail>
-    static void SetVal(U&& value, InPlaceIndex<0>, Union<UnionIndex, Head, Tail...>& u) {
-        u.head = value;
+    template <size_t I, typename... Args>
+    constexpr explicit Union(InPlaceIndex<I>, Args&&... args)
+        : tail(kInPlaceIndex<I - 1>, std::forward<Args>(args)...) {
     }
 
-    template <size_t Index, typename U, size_t UnionIndex, typename Head, typename... Tail>
-    static void SetVal(U&& value, InPlaceIndex<Index>, Union<UnionIndex, Head, Tail...>& u) {
-        AssignUnion::SetVal<Index - 1>(std::forward<U>(value), kInPlaceIndex<Index - 1>, u.tail);
+    // Defaulted when every alternative is trivially destructible, which keeps a Variant
+    // of such types trivially destructible and copyable (memcpy-able in containers).
+    ~Union() requires(std::is_trivially_destructible_v<T> &&
+                      (std::is_trivially_destructible_v<Types> && ...)) = default;
+
+    // The live alternative is destroyed by Variant, which knows which one it is.
+    constexpr ~Union() {
     }
 };
 
@@ -135,6 +141,84 @@ struct FindExactlyOneChecked<T> {
 template <typename TargetType, typename... Types>
 struct FindExactlyOneType : public FindExactlyOneChecked<TargetType, Types...> {};
 
+// Alternative picked by the converting constructor and assignment from a U: the one
+// whose overload F(Ti) would win for F(std::forward<U>(u)) when every Ti is offered
+// as a candidate. Narrowing conversions do not count, so 12.0 never selects an int.
+template <typename T>
+struct SingleElementArray {
+    T value[1];
+};
+
+template <size_t I, typename Ti, typename U, typename = void>
+struct ConvertingCandidate {
+    static void Test();
+};
+
+template <size_t I, typename Ti, typename U>
+struct ConvertingCandidate<I, Ti, U,
+                           std::void_t<decltype(SingleElementArray<Ti>{{std::declval<U>()}})>> {
+    static std::integral_constant<size_t, I> Test(Ti);
+};
+
+template <typename U, typename Indices, typename... Types>
+struct ConvertingCandidates;
+
+template <typename U, size_t... Indices, typename... Types>
+struct ConvertingCandidates<U, std::index_sequence<Indices...>, Types...>
+    : ConvertingCandidate<Indices, Types, U>... {
+    using ConvertingCandidate<Indices, Types, U>::Test...;
+};
+
+// Substitution failure when no alternative or more than one fits equally well.
+template <typename U, typename... Types>
+using ConvertingIndex = decltype(ConvertingCandidates<U, std::index_sequence_for<Types...>,
+                                                      Types...>::Test(std::declval<U>()));
+
+template <typename... Types>
+concept AllCopyConstructible = (std::is_copy_constructible_v<Types> && ...);
+
+template <typename... Types>
+concept AllTriviallyCopyConstructible =
+    AllCopyConstructible<Types...> && (std::is_trivially_copy_constructible_v<Types> && ...);
+
+template <typename... Types>
+concept AllMoveConstructible = (std::is_move_constructible_v<Types> && ...);
+
+template <typename... Types>
+concept AllTriviallyMoveConstructible =
+    AllMoveConstructible<Types...> && (std::is_trivially_move_constructible_v<Types> && ...);
+
+template <typename... Types>
+concept AllCopyAssignable =
+    AllCopyConstructible<Types...> && (std::is_copy_assignable_v<Types> && ...);
+
+template <typename... Types>
+concept AllTriviallyCopyAssignable =
+    AllCopyAssignable<Types...> && (std::is_trivially_copy_assignable_v<Types> && ...) &&
+    (std::is_trivially_copy_constructible_v<Types> && ...) &&
+    (std::is_trivially_destructible_v<Types> && ...);
+
+template <typename... Types>
+concept AllMoveAssignable =
+    AllMoveConstructible<Types...> && (std::is_move_assignable_v<Types> && ...);
+
+template <typename... Types>
+concept AllTriviallyMoveAssignable =
+    AllMoveAssignable<Types...> && (std::is_trivially_move_assignable_v<Types> && ...) &&
+    (std::is_trivially_move_constructible_v<Types> && ...) &&
+    (std::is_trivially_destructible_v<Types> && ...);
+
+// Index() of a variant left without an alternative by a throwing Emplace
+constexpr size_t kVariantNpos = -1;
+
+// Thrown when a valueless variant is visited
+class BadVariantAccess : public std::exception {
+public:
+    const char* what() const noexcept override {
+        return "task::BadVariantAccess";
+    }
+};
+
 template <typename... Types>
 class Variant;
 
@@ -149,34 +233,287 @@ struct VariantAlternative<Idx, Variant<Types...>> {
     using type = typename TypeAt<Idx, TypeList<Types...>>::result;
 };
 
+template <typename T>
+struct VariantSize;
+
+template <typename... Types>
+struct VariantSize<Variant<Types...>> : std::integral_constant<size_t, sizeof...(Types)> {};
+
+template <typename T>
+constexpr size_t variant_size_v = VariantSize<std::remove_cv_t<std::remove_reference_t<T>>>::value;
+
+// Smallest unsigned type that can hold every alternative index, the largest value is
+// kept free for a "no alternative" marker.
+template <size_t Count>
+using VariantIndex =
+    std::conditional_t<(Count < UINT8_MAX), uint8_t,
+                       std::conditional_t<(Count < UINT16_MAX), uint16_t, uint32_t>>;
+
 template <typename... Types>
 class Variant {
+    using IndexType = VariantIndex<sizeof...(Types)>;
+    static constexpr IndexType kValueless = static_cast<IndexType>(-1);
+
 public:
     // Special member functions
-    constexpr Variant() noexcept {};
+    // Exactly one alternative is alive at a time: the first one, value-initialized.
+    constexpr Variant() noexcept(
+        std::is_nothrow_default_constructible_v<variant_alternative_t<0, Variant>>)
+        : data_(kInPlaceIndex<0>), index_(0) {
+    }
+
+    Variant(const Variant&) requires AllTriviallyCopyConstructible<Types...> = default;
+
+    constexpr Variant(const Variant& other) requires AllCopyConstructible<Types...> {
+        other.WithIndex([&](auto i) { Construct<i>(GenericGet<i>(other)); });
+    }
+
+    Variant(Variant&&) requires AllTriviallyMoveConstructible<Types...> = default;
+
+    constexpr Variant(Variant&& other) noexcept(
+        (std::is_nothrow_move_constructible_v<Types> && ...))
+        requires AllMoveConstructible<Types...> {
+        other.WithIndex([&](auto i) { Construct<i>(GenericGet<i>(std::move(other))); });
+    }
+
+    // Constructs the alternative overload resolution picks for t, in place.
+    template <typename T,
+              typename = std::enable_if_t<!std::is_same_v<std::remove_cvref_t<T>, Variant>>,
+              size_t Position = ConvertingIndex<T, Types...>::value>
+    constexpr Variant(T&& t)  // NOLINT
+        : data_(kInPlaceIndex<Position>, std::forward<T>(t)), index_(Position) {
+    }
+
+    ~Variant() requires(std::is_trivially_destructible_v<Types> && ...) = default;
+
+    constexpr ~Variant() {
+        Reset();
+    }
+
+    Variant& operator=(const Variant&) requires AllTriviallyCopyAssignable<Types...> = default;
+
+    constexpr Variant& operator=(const Variant& other) requires AllCopyAssignable<Types...> {
+        if (other.index_ == kValueless) {
+            Reset();
+        }
+        other.WithIndex([&](auto i) {
+            if (index_ == i) {
+                GenericGet<i>(*this) = GenericGet<i>(other);
+            } else {
+                Emplace<i>(GenericGet<i>(other));
+            }
+        });
+        return *this;
+    }
+
+    Variant& operator=(Variant&&) requires AllTriviallyMoveAssignable<Types...> = default;
 
-    template <typename T, size_t Position = FindExactlyOneType<T, Types...>::kValue>
-    Variant& operator=(T&& t) noexcept {
-        AssignUnion::SetVal<Position>(std::forward<T>(t), kInPlaceIndex<Position>, data_);
+    constexpr Variant& operator=(Variant&& other) noexcept(
+        ((std::is_nothrow_move_constructible_v<Types> &&
+          std::is_nothrow_move_assignable_v<Types>)&&...)) requires AllMoveAssignable<Types...> {
+        if (other.index_ == kValueless) {
+            Reset();
+        }
+        other.WithIndex([&](auto i) {
+            if (index_ == i) {
+                GenericGet<i>(*this) = GenericGet<i>(std::move(other));
+            } else {
+                Emplace<i>(GenericGet<i>(std::move(other)));
+            }
+        });
         return *this;
     }
 
+    // Assigns to the live alternative when t maps to it, otherwise destroys that one
+    // and constructs the new alternative directly from t.
+    template <typename T,
+              typename = std::enable_if_t<!std::is_same_v<std::remove_cvref_t<T>, Variant>>,
+              size_t Position = ConvertingIndex<T, Types...>::value>
+    constexpr Variant& operator=(T&& t) {
+        if (index_ == Position) {
+            GenericGet<Position>(*this) = std::forward<T>(t);
+        } else {
+            Emplace<Position>(std::forward<T>(t));
+        }
+        return *this;
+    }
+
+    // Modifiers
+    // Destroys the live alternative and constructs the I-th one from args in its
+    // place. If that constructor throws the variant is left valueless.
+    template <size_t I, typename... Args>
+    constexpr variant_alternative_t<I, Variant>& Emplace(Args&&... args) {
+        Reset();
+        Construct<I>(std::forward<Args>(args)...);
+        return GenericGet<I>(*this);
+    }
+
+    template <typename T, typename... Args>
+    constexpr T& Emplace(Args&&... args) {
+        return Emplace<FindExactlyOneType<T, Types...>::kValue>(std::forward<Args>(args)...);
+    }
+
+    // Observers
+    // Index of the live alternative, kVariantNpos if there is none
+    constexpr size_t Index() const noexcept {
+        return index_ == kValueless ? kVariantNpos : index_;
+    }
+
+    constexpr bool ValuelessByException() const noexcept {
+        return index_ == kValueless;
+    }
+
 private:
+    // Calls f with std::integral_constant<size_t, Index()>, unless valueless.
+    template <typename F>
+    constexpr void WithIndex(F&& f) const {
+        [&]<size_t... Indices>(std::index_sequence<Indices...>) {
+            ((index_ == Indices ? (f(std::integral_constant<size_t, Indices>()), true) : false) ||
+             ...);
+        }(std::index_sequence_for<Types...>());
+    }
+
+    // Expects no live alternative.
+    template <size_t I, typename... Args>
+    constexpr void Construct(Args&&... args) {
+        std::construct_at(&data_, kInPlaceIndex<I>, std::forward<Args>(args)...);
+        index_ = static_cast<IndexType>(I);
+    }
+
+    constexpr void Reset() noexcept {
+        if constexpr (!(std::is_trivially_destructible_v<Types> && ...)) {
+            WithIndex([&](auto i) { std::destroy_at(&GenericGet<i>(*this)); });
+        }
+        index_ = kValueless;
+    }
+
     Union<0, Types...> data_;
+    IndexType index_ = kValueless;
     friend AccessVariant;
 };
 
 template <size_t Idx, typename T>
-auto&& GenericGet(T&& v) {
+constexpr auto&& GenericGet(T&& v) {
     return AccessVariant::GetVal<Idx>(std::forward<T>(v));
 }
 
+// Visit dispatches on the combination of all the variants' indices, flattened into
+// one number (the last variant's index varies fastest). Up to kSwitchCases
+// combinations are dispatched with a switch, which compilers turn into a jump table
+// they can also inline through; larger ones index a table of function pointers
+// generated at compile time. Either way the cost does not depend on the index.
+struct VisitDispatch {
+    static constexpr size_t kSwitchCases = 8;
+
+    template <typename... Variants>
+    static constexpr size_t kCombinations = (variant_size_v<Variants> * ... * 1);
+
+    // Alternative of the Position-th variant in the combination number Flat
+    template <size_t Flat, size_t Position, typename... Variants>
+    static constexpr size_t AlternativeAt() {
+        constexpr size_t sizes[] = {variant_size_v<Variants>...};
+        size_t stride = 1;
+        for (size_t i = Position + 1; i < sizeof...(Variants); ++i) {
+            stride *= sizes[i];
+        }
+        return Flat / stride % sizes[Position];
+    }
+
+    template <size_t Flat, typename Visitor, typename... Variants, size_t... Positions>
+    static constexpr decltype(auto) InvokeAt(std::index_sequence<Positions...>, Visitor&& visitor,
+                                             Variants&&... variants) {
+        return std::invoke(
+            std::forward<Visitor>(visitor),
+            GenericGet<AlternativeAt<Flat, Positions, Variants...>()>(
+                std::forward<Variants>(variants))...);
+    }
+
+    template <size_t Flat, typename Visitor, typename... Variants>
+    static constexpr decltype(auto) Invoke(Visitor&& visitor, Variants&&... variants) {
+        return InvokeAt<Flat>(std::index_sequence_for<Variants...>(),
+                              std::forward<Visitor>(visitor), std::forward<Variants>(variants)...);
+    }
+
+    template <typename Visitor, typename... Variants>
+    using Result = decltype(Invoke<0>(std::declval<Visitor>(), std::declval<Variants>()...));
+
+    template <typename Visitor, typename... Variants, size_t... Flat>
+    static constexpr auto MakeTable(std::index_sequence<Flat...>) {
+        using Function = Result<Visitor, Variants...> (*)(Visitor&&, Variants&&...);
+        return std::array<Function, sizeof...(Flat)>{&Invoke<Flat, Visitor, Variants...>...};
+    }
+
+    template <typename Visitor, typename... Variants>
+    static constexpr auto kTable = MakeTable<Visitor, Variants...>(
+        std::make_index_sequence<kCombinations<Variants...>>());
+
+    // Cases past the last combination are never taken, they only keep the switch uniform.
+    template <size_t Flat, typename Visitor, typename... Variants>
+    static constexpr decltype(auto) Case(Visitor&& visitor, Variants&&... variants) {
+        constexpr size_t kFlat = Flat < kCombinations<Variants...> ? Flat : 0;
+        return Invoke<kFlat>(std::forward<Visitor>(visitor), std::forward<Variants>(variants)...);
+    }
+
+    template <typename Visitor, typename... Variants>
+    static constexpr decltype(auto) Run(Visitor&& visitor, Variants&&... variants) {
+        size_t flat = 0;
+        ((flat = flat * variant_size_v<Variants> + variants.Index()), ...);
+
+        if constexpr (kCombinations<Variants...> <= kSwitchCases) {
+            switch (flat) {
+                case 0:
+                    return Case<0>(std::forward<Visitor>(visitor),
+                                   std::forward<Variants>(variants)...);
+                case 1:
+                    return Case<1>(std::forward<Visitor>(visitor),
+                                   std::forward<Variants>(variants)...);
+                case 2:
+                    return Case<2>(std::forward<Visitor>(visitor),
+                                   std::forward<Variants>(variants)...);
+                case 3:
+                    return Case<3>(std::forward<Visitor>(visitor),
+                                   std::forward<Variants>(variants)...);
+                case 4:
+                    return Case<4>(std::forward<Visitor>(visitor),
+                                   std::forward<Variants>(variants)...);
+                case 5:
+                    return Case<5>(std::forward<Visitor>(visitor),
+                                   std::forward<Variants>(variants)...);
+                case 6:
+                    return Case<6>(std::forward<Visitor>(visitor),
+                                   std::forward<Variants>(variants)...);
+                default:
+                    return Case<7>(std::forward<Visitor>(visitor),
+                                   std::forward<Variants>(variants)...);
+            }
+        } else {
+            return kTable<Visitor, Variants...>[flat](std::forward<Visitor>(visitor),
+                                                      std::forward<Variants>(variants)...);
+        }
+    }
+};
+
+// Calls visitor with the active alternatives of all the variants; every combination
+// has to produce the same return type. Throws BadVariantAccess if any is valueless.
+template <typename Visitor, typename... Variants>
+constexpr decltype(auto) Visit(Visitor&& visitor, Variants&&... variants) {
+    if ((variants.ValuelessByException() || ...)) {
+        throw BadVariantAccess();
+    }
+    return VisitDispatch::Run(std::forward<Visitor>(visitor), std::forward<Variants>(variants)...);
+}
+
 // Non-member functions
 template <size_t I, typename... Types>
 constexpr const variant_alternative_t<I, Variant<Types...>>& Get(Variant<Types...>& v) {
     return GenericGet<I>(v);
 }
 
+template <size_t I, typename... Types>
+constexpr const variant_alternative_t<I, Variant<Types...>>& Get(const Variant<Types...>& v) {
+    return GenericGet<I>(v);
+}
+
 template <size_t I, typename... Types>
 constexpr variant_alternative_t<I, Variant<Types...>>&& Get(Variant<Types...>&& v) {
     return GenericGet<I>(v);
@@ -187,6 +524,11 @@ constexpr const T& Get(Variant<Types...>& v) {
     return GenericGet<FindExactlyOneType<T, Types...>::kValue>(v);
 }
 
+template <typename T, typename... Types>
+constexpr const T& Get(const Variant<Types...>& v) {
+    return GenericGet<FindExactlyOneType<T, Types...>::kValue>(v);
+}
+
 template <typename T, typename... Types>
 constexpr T&& Get(Variant<Types...>&& v) {
     return GenericGet<FindExactlyOneType<T, Types...>::kValue>(v);
@@ -0,0 +1,173 @@
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "variant.h"
+
+#pragma once
+
+namespace task {
+// Sequence of Variant<Types...> values stored as a structure of arrays: every
+// alternative lives in its own contiguous vector without padding or a tag, and the
+// element order is kept in a compact tag stream (one byte per element for up to 254
+// alternatives) plus the position of each element in its alternative's vector. Bulk
+// work over one type never looks at the tags.
+template <typename... Types>
+class VariantVector {
+public:
+    using value_type = Variant<Types...>;
+
+    template <size_t I>
+    using Alternative = variant_alternative_t<I, value_type>;
+
+    // Modifiers
+    template <size_t I, typename... Args>
+    Alternative<I>& Emplace(Args&&... args) {
+        auto& values = std::get<I>(alternatives_);
+        tags_.push_back(static_cast<IndexType>(I));
+        offsets_.push_back(static_cast<uint32_t>(values.size()));
+        return values.emplace_back(std::forward<Args>(args)...);
+    }
+
+    template <typename T, typename... Args>
+    T& Emplace(Args&&... args) {
+        return Emplace<FindExactlyOneType<T, Types...>::kValue>(std::forward<Args>(args)...);
+    }
+
+    // Appends the alternative a Variant<Types...> would hold after construction from t.
+    template <typename T,
+              typename = std::enable_if_t<!std::is_same_v<std::remove_cvref_t<T>, value_type>>,
+              size_t Position = ConvertingIndex<T, Types...>::value>
+    void PushBack(T&& t) {
+        Emplace<Position>(std::forward<T>(t));
+    }
+
+    // Throws BadVariantAccess for a valueless v.
+    void PushBack(const value_type& v) {
+        if (v.ValuelessByException()) {
+            throw BadVariantAccess();
+        }
+        WithIndex(v.Index(), [&](auto i) { Emplace<i>(GenericGet<i>(v)); });
+    }
+
+    void Reserve(size_t size) {
+        tags_.reserve(size);
+        offsets_.reserve(size);
+    }
+
+    void Clear() noexcept {
+        std::apply([](auto&... values) { (values.clear(), ...); }, alternatives_);
+        tags_.clear();
+        offsets_.clear();
+    }
+
+    // Observers
+    size_t Size() const noexcept {
+        return tags_.size();
+    }
+
+    bool Empty() const noexcept {
+        return tags_.empty();
+    }
+
+    // Alternative held by the i-th element
+    size_t Index(size_t i) const noexcept {
+        return tags_[i];
+    }
+
+    template <size_t I>
+    Alternative<I>& Get(size_t i) {
+        return std::get<I>(alternatives_)[offsets_[i]];
+    }
+
+    template <size_t I>
+    const Alternative<I>& Get(size_t i) const {
+        return std::get<I>(alternatives_)[offsets_[i]];
+    }
+
+    // All the values of the I-th alternative, in insertion order
+    template <size_t I>
+    std::span<Alternative<I>> Values() noexcept {
+        return std::get<I>(alternatives_);
+    }
+
+    template <size_t I>
+    std::span<const Alternative<I>> Values() const noexcept {
+        return std::get<I>(alternatives_);
+    }
+
+    // Calls visitor with the i-th element
+    template <typename Visitor>
+    decltype(auto) Visit(size_t i, Visitor&& visitor) {
+        return VisitAt(*this, i, std::forward<Visitor>(visitor));
+    }
+
+    template <typename Visitor>
+    decltype(auto) Visit(size_t i, Visitor&& visitor) const {
+        return VisitAt(*this, i, std::forward<Visitor>(visitor));
+    }
+
+    // Calls visitor with every element, one alternative after another: all values of
+    // the first alternative, then of the second and so on. Each run is a plain loop
+    // over a contiguous array the compiler can inline and vectorize.
+    template <typename Visitor>
+    void VisitAll(Visitor&& visitor) {
+        std::apply([&](auto&... values) { (RunOver(values, visitor), ...); }, alternatives_);
+    }
+
+    template <typename Visitor>
+    void VisitAll(Visitor&& visitor) const {
+        std::apply([&](const auto&... values) { (RunOver(values, visitor), ...); },
+                   alternatives_);
+    }
+
+private:
+    using IndexType = VariantIndex<sizeof...(Types)>;
+
+    template <typename Values, typename Visitor>
+    static void RunOver(Values& values, Visitor& visitor) {
+        for (auto& value : values) {
+            visitor(value);
+        }
+    }
+
+    // Calls f with std::integral_constant<size_t, index>.
+    template <typename F>
+    static void WithIndex(size_t index, F&& f) {
+        [&]<size_t... Indices>(std::index_sequence<Indices...>) {
+            ((index == Indices ? (f(std::integral_constant<size_t, Indices>()), true) : false) ||
+             ...);
+        }(std::index_sequence_for<Types...>());
+    }
+
+    template <size_t I, typename Self, typename Visitor>
+    static decltype(auto) VisitOne(Self& self, size_t i, Visitor&& visitor) {
+        return std::invoke(std::forward<Visitor>(visitor), self.template Get<I>(i));
+    }
+
+    // Same dispatch as task::Visit past its switch: one table of function pointers
+    // per visitor type, indexed by the element's tag.
+    template <typename Self, typename Visitor, size_t... Indices>
+    static constexpr auto MakeTable(std::index_sequence<Indices...>) {
+        using Result = decltype(VisitOne<0>(std::declval<Self&>(), 0, std::declval<Visitor>()));
+        using Function = Result (*)(Self&, size_t, Visitor&&);
+        return std::array<Function, sizeof...(Indices)>{&VisitOne<Indices, Self, Visitor>...};
+    }
+
+    template <typename Self, typename Visitor>
+    static decltype(auto) VisitAt(Self& self, size_t i, Visitor&& visitor) {
+        static constexpr auto kTable =
+            MakeTable<Self, Visitor>(std::index_sequence_for<Types...>());
+        return kTable[self.tags_[i]](self, i, std::forward<Visitor>(visitor));
+    }
+
+    std::tuple<std::vector<Types>...> alternatives_;
+    std::vector<IndexType> tags_;
+    // Position of each element in its alternative's vector
+    std::vector<uint32_t> offsets_;
+};
+}  // namespace task
@@ -1,72 +1,23 @@
-#include "allocator.h"
-
-template<typename T>
-SimpleAllocator<T>::SimpleAllocator() {
-    arena = ::operator new(2000 * sizeof(T));
-}
+#include <list>
+#include <map>
 
-template<typename T>
-SimpleAllocator<T>::SimpleAllocator(const SimpleAllocator& other) noexcept :
-    arena(other.arena)
-{
-}
-
-template<typename T>
-template<typename U>
-SimpleAllocator<T>::SimpleAllocator(const SimpleAllocator<U>& other) noexcept : 
-    arena(other.arena)
-{
-}
+#include "allocator.h"
 
-template<typename T>
-SimpleAllocator<T>::~SimpleAllocator()
-{
-    num_allocators--;
-    if (num_allocators) {
-        delete arena;
+int main() {
+    // После rebind'а std::list запрашивает у аллокатора по одному узлу,
+    // узлы берутся из пула и возвращаются в его free list
+    std::list<int, SimpleAllocator<int>> lst;
+    for (int i = 0; i < 1000; ++i) {
+        lst.push_back(i);
     }
-}
-
+    lst.clear();
 
-template<typename T>
-SimpleAllocator<T> SimpleAllocator<T>::select_on_container_copy_construction() const {
-    return SimpleAllocator();
-}
-
-template<typename T>
-T* SimpleAllocator<T>::allocate(std::size_t n) {
-    return ::operator new(n * sizeof(T));
-}
-
-template<typename T>
-void SimpleAllocator<T>::deallocate(void* p, std::size_t n) {
-    ::operator delete(p);
-}
-
-template<typename T, typename U>
-bool operator==(const SimpleAllocator<T>& lhs, const SimpleAllocator<U>& rhs) noexcept {
-    return true;
-}
-
-template<typename T, typename U>
-bool operator!=(const SimpleAllocator<T>& lhs, const SimpleAllocator<U>& rhs) noexcept {
-    return true;
-}
-
-template<typename T>
-template<typename... Args>
-void SimpleAllocator<T>::construct(void* p, Args&&... args) {
-    // new(p) - это new expression (конкретнее placement new expression),  
-    // который вызывает new operator
-
-    new(p) value_type(std::forward<Args>(args)...);
-}
+    std::map<int, int, std::less<int>, SimpleAllocator<std::pair<const int, int>>> map;
+    for (int i = 0; i < 1000; ++i) {
+        map[i] = i;
+    }
 
-template<typename T>
-void SimpleAllocator<T>::destroy(void* p) {
-    ::delete(p);
+    // select_on_container_copy_construction: копия контейнера получает свою арену
+    auto copy = map;
+    return copy.get_allocator() == map.get_allocator() ? 1 : 0;
 }
-
-int main() {
-    return 0;
-}
\ No newline at end of file
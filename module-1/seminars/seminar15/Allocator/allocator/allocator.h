@@ -1,14 +1,102 @@
+#pragma once
+
+#include <cstddef>
 #include <memory>
+#include <new>
 #include <type_traits>
+#include <vector>
+
+namespace detail {
+
+// Пул блоков одного размера: память берется чанками по kBlocksPerChunk блоков,
+// освобожденные блоки складываются в односвязный free list и переиспользуются
+class Pool {
+    public:
+        explicit Pool(std::size_t block_size) : block_size(block_size) {}
+
+        Pool(const Pool&) = delete;
+        Pool& operator=(const Pool&) = delete;
+        Pool(Pool&& other) noexcept :
+            block_size(other.block_size),
+            free_list(other.free_list),
+            chunks(std::move(other.chunks))
+        {
+            other.free_list = nullptr;
+        }
+
+        ~Pool() {
+            for (void* chunk : chunks) {
+                ::operator delete(chunk);
+            }
+        }
+
+        void* allocate() {
+            if (free_list == nullptr) {
+                grow();
+            }
+            FreeBlock* block = free_list;
+            free_list = block->next;
+            return block;
+        }
+
+        void deallocate(void* p) {
+            FreeBlock* block = static_cast<FreeBlock*>(p);
+            block->next = free_list;
+            free_list = block;
+        }
 
-template<typename T>
-class SimpleAllocator {
     private:
-        template<typename U> 
-        struct rebind {
-            using other = SimpleAllocator<U>;
+        struct FreeBlock {
+            FreeBlock* next;
         };
 
+        static const std::size_t kBlocksPerChunk = 256;
+
+        void grow() {
+            char* chunk = static_cast<char*>(::operator new(block_size * kBlocksPerChunk));
+            chunks.push_back(chunk);
+            for (std::size_t i = kBlocksPerChunk; i > 0; --i) {
+                deallocate(chunk + (i - 1) * block_size);
+            }
+        }
+
+        std::size_t block_size;
+        FreeBlock* free_list = nullptr;
+        std::vector<void*> chunks;
+};
+
+// Общая для всех копий и rebind'ов аллокатора память:
+// по пулу на каждый класс размеров kGranularity, 2 * kGranularity, ...
+struct Arena {
+    static const std::size_t kGranularity = alignof(std::max_align_t);
+    static const std::size_t kSizeClasses = 16;
+
+    Arena() {
+        pools.reserve(kSizeClasses);
+        for (std::size_t i = 1; i <= kSizeClasses; ++i) {
+            pools.emplace_back(i * kGranularity);
+        }
+    }
+
+    // nullptr, если блок такого размера пулом не обслуживается
+    Pool* find_pool(std::size_t bytes, std::size_t alignment) {
+        if (bytes == 0 || bytes > kSizeClasses * kGranularity || alignment > kGranularity) {
+            return nullptr;
+        }
+        return &pools[(bytes - 1) / kGranularity];
+    }
+
+    std::size_t num_allocators = 1;
+    std::vector<Pool> pools;
+};
+
+}  // namespace detail
+
+template<typename T>
+class SimpleAllocator {
+    template<typename U>
+    friend class SimpleAllocator;
+
     public:
 
         using value_type = T;
@@ -17,30 +105,133 @@ class SimpleAllocator {
         using const_pointer = const T*;
         using const_reference = const T&;
         using size_type = std::size_t;
-        using pointer_difference = std::ptrdiff_t;
+        using difference_type = std::ptrdiff_t;
         using propagate_on_container_move_assignment = std::false_type;
         using propagate_on_container_copy_assignment = std::false_type;
-        using propogate_on_container_swap = std::false_type;
+        using propagate_on_container_swap = std::false_type;
         using is_always_equal = std::false_type;
 
+        template<typename U>
+        struct rebind {
+            using other = SimpleAllocator<U>;
+        };
+
         SimpleAllocator();
         SimpleAllocator(const SimpleAllocator& other) noexcept;
+        SimpleAllocator& operator=(const SimpleAllocator& other) noexcept;
         ~SimpleAllocator();
 
         template<typename U>
         SimpleAllocator(const SimpleAllocator<U>& other) noexcept;
-        
+
         SimpleAllocator select_on_container_copy_construction() const;
-        
+
         T* allocate(std::size_t n);
-        // void* allocate(std::size_t n, void* cvp);
-        void deallocate(void* p, std::size_t n);
-        // std::size_t max_size() const noexcept;
-        template<typename... Args>
-        void construct(void* p, Args&&... args);
-        void destroy(void* p);
-
-        private:
-            std::size_t num_allocators = 0;
-            void* arena;
-};
\ No newline at end of file
+        void deallocate(T* p, std::size_t n);
+        template<typename U, typename... Args>
+        void construct(U* p, Args&&... args);
+        template<typename U>
+        void destroy(U* p);
+
+        template<typename K, typename U>
+        friend bool operator==(const SimpleAllocator<K>& lhs, const SimpleAllocator<U>& rhs) noexcept;
+
+    private:
+        void release();
+
+        detail::Arena* arena;
+};
+
+template<typename T>
+SimpleAllocator<T>::SimpleAllocator() :
+    arena(new detail::Arena())
+{
+}
+
+template<typename T>
+SimpleAllocator<T>::SimpleAllocator(const SimpleAllocator& other) noexcept :
+    arena(other.arena)
+{
+    arena->num_allocators++;
+}
+
+template<typename T>
+template<typename U>
+SimpleAllocator<T>::SimpleAllocator(const SimpleAllocator<U>& other) noexcept :
+    arena(other.arena)
+{
+    arena->num_allocators++;
+}
+
+template<typename T>
+SimpleAllocator<T>& SimpleAllocator<T>::operator=(const SimpleAllocator& other) noexcept {
+    if (arena != other.arena) {
+        release();
+        arena = other.arena;
+        arena->num_allocators++;
+    }
+    return *this;
+}
+
+template<typename T>
+SimpleAllocator<T>::~SimpleAllocator()
+{
+    release();
+}
+
+template<typename T>
+void SimpleAllocator<T>::release() {
+    arena->num_allocators--;
+    if (arena->num_allocators == 0) {
+        delete arena;
+    }
+}
+
+template<typename T>
+SimpleAllocator<T> SimpleAllocator<T>::select_on_container_copy_construction() const {
+    return SimpleAllocator();
+}
+
+template<typename T>
+T* SimpleAllocator<T>::allocate(std::size_t n) {
+    detail::Pool* pool = arena->find_pool(n * sizeof(T), alignof(T));
+    if (pool == nullptr) {
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+    return static_cast<T*>(pool->allocate());
+}
+
+template<typename T>
+void SimpleAllocator<T>::deallocate(T* p, std::size_t n) {
+    detail::Pool* pool = arena->find_pool(n * sizeof(T), alignof(T));
+    if (pool == nullptr) {
+        ::operator delete(p);
+        return;
+    }
+    pool->deallocate(p);
+}
+
+template<typename T, typename U>
+bool operator==(const SimpleAllocator<T>& lhs, const SimpleAllocator<U>& rhs) noexcept {
+    return lhs.arena == rhs.arena;
+}
+
+template<typename T, typename U>
+bool operator!=(const SimpleAllocator<T>& lhs, const SimpleAllocator<U>& rhs) noexcept {
+    return !(lhs == rhs);
+}
+
+template<typename T>
+template<typename U, typename... Args>
+void SimpleAllocator<T>::construct(U* p, Args&&... args) {
+    // new(p) - это new expression (конкретнее placement new expression),
+    // который вызывает new operator
+
+    new(p) U(std::forward<Args>(args)...);
+}
+
+template<typename T>
+template<typename U>
+void SimpleAllocator<T>::destroy(U* p) {
+    p->~U();
+}
@@ -0,0 +1,61 @@
+#include <chrono>
+#include <iostream>
+#include <list>
+#include <map>
+#include <string>
+
+#include "allocator.h"
+
+namespace {
+
+const int kElements = 100000;
+const int kRounds = 20;
+
+template<typename Function>
+void run(const std::string& name, Function function) {
+    auto start = std::chrono::steady_clock::now();
+    long long checksum = 0;
+    for (int round = 0; round < kRounds; ++round) {
+        checksum += function();
+    }
+    auto finish = std::chrono::steady_clock::now();
+
+    double ms = std::chrono::duration<double, std::milli>(finish - start).count();
+    std::cout << name << ": " << ms / kRounds << " ms/round (checksum " << checksum << ")\n";
+}
+
+template<typename Allocator>
+long long list_workload() {
+    std::list<int, Allocator> lst;
+    for (int i = 0; i < kElements; ++i) {
+        lst.push_back(i);
+        if (i % 3 == 0) {
+            lst.pop_front();
+        }
+    }
+    return static_cast<long long>(lst.size());
+}
+
+template<typename Allocator>
+long long map_workload() {
+    std::map<int, int, std::less<int>, Allocator> map;
+    for (int i = 0; i < kElements; ++i) {
+        map[(i * 7919) % kElements] = i;
+        if (i % 4 == 0) {
+            map.erase((i * 104729) % kElements);
+        }
+    }
+    return static_cast<long long>(map.size());
+}
+
+}  // namespace
+
+int main() {
+    using Pair = std::pair<const int, int>;
+
+    run("std::list<std::allocator>", list_workload<std::allocator<int>>);
+    run("std::list<SimpleAllocator>", list_workload<SimpleAllocator<int>>);
+    run("std::map<std::allocator>", map_workload<std::allocator<Pair>>);
+    run("std::map<SimpleAllocator>", map_workload<SimpleAllocator<Pair>>);
+    return 0;
+}
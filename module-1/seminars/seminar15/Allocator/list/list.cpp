@@ -1,3 +1,5 @@
+#include <cstdlib>
+
 #include "list.h"
 
 // Special member functions
@@ -63,6 +65,7 @@ task::list<T, Allocator>::list(list&& other, const Allocator& alloc) :
 
 template<typename T, typename Allocator>
 task::list<T, Allocator>::~list() {
+    clear();
     alloc.destroy(head);
     alloc.deallocate(head, 1);
     alloc.destroy(tail);
@@ -169,7 +172,7 @@ template<typename T, typename Allocator>
 void task::list<T, Allocator>::pop_back() 
 { 
     Node* p = tail->prev;
-    tail->prev->next = tail;
+    p->prev->next = tail;
     tail->prev = p->prev;
     alloc.destroy(p);
     alloc.deallocate(p, 1);
@@ -186,7 +189,7 @@ template<typename T, typename Allocator>
 void task::list<T, Allocator>::swap(list& other) noexcept 
 {   
     // использовал decltype, чтобы не писать __node_allocator
-    if (!std::allocator_traits<decltype(alloc)>::propogate_on_container_swap::value && get_allocator() != other.get_allocator()) {
+    if (!std::allocator_traits<decltype(alloc)>::propagate_on_container_swap::value && get_allocator() != other.get_allocator()) {
         std::exit(0);
     }
     // стандарт запрещает делать swap на элементах контейнера
@@ -218,6 +221,11 @@ typename task::list<T, Allocator>::size_type task::list<T, Allocator>::size() co
 }
 
 int main() {
-    task::list<int> lst;
+    task::list<int, SimpleAllocator<int>> lst;
+    for (int i = 0; i < 100; ++i) {
+        lst.push_back(i);
+        lst.emplace_back(i);
+    }
+    lst.pop_back();
     return 0;
 }
\ No newline at end of file
@@ -111,6 +111,12 @@ private:
 
         Node() = default;
 
+        // для push_back/emplace_back: value конструируется прямо в узле
+        template<typename... Args>
+        explicit Node(Args&&... args) :
+            value(std::forward<Args>(args)...)
+        {}
+
         Node(value_type _value, Node* _next, Node* _prev) :
             value(_value),
             next(_next),